@@ -0,0 +1,57 @@
+/*
+ * LedController Example
+ *
+ * Drives four strips on separate data lines from one render task: two on
+ * I2S0 in parallel mode and two on RMT channels. All strips are rendered
+ * first and then shown back to back, so their transfers overlap and a
+ * frame takes as long as the longest strip.
+ */
+
+#include <Arduino.h>
+#include <espmods/led.hpp>
+
+using espmods::led::FixedLedStrip;
+using espmods::led::LedController;
+
+// I2S0 in 8-lane parallel mode; MicI2S keeps I2S1 for the microphone
+FixedLedStrip<300, NeoGrbFeature, NeoEsp32I2s0X8Ws2812xMethod> frontStrip(16);
+FixedLedStrip<300, NeoGrbFeature, NeoEsp32I2s0X8Ws2812xMethod> backStrip(17);
+
+// RMT channels transmit on their own once Show() is called
+FixedLedStrip<144, NeoGrbwFeature, NeoEsp32Rmt0Ws2812xMethod> shelfStrip(18);
+FixedLedStrip<60, NeoGrbFeature, NeoEsp32Rmt1Ws2812xMethod> signStrip(19);
+
+LedController controller;
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("LedController Example Starting...");
+
+  controller.addStrip(frontStrip);
+  controller.addStrip(backStrip);
+  controller.addStrip(shelfStrip);
+  controller.addStrip(signStrip);
+  controller.begin();
+
+  frontStrip.rainbow();
+  backStrip.colorWave(0xFF0000, 0x0000FF);
+  shelfStrip.setSolidColor(0xFFC080);
+  signStrip.pulseColor(0xFF4400);
+
+  if (!controller.startRenderTask()) {
+    Serial.println("Render task failed to start, rendering from loop()");
+  }
+}
+
+void loop() {
+  // No-op while the render task runs
+  controller.update();
+
+  static uint32_t lastReport = 0;
+  if (millis() - lastReport > 5000) {
+    lastReport = millis();
+    Serial.printf("Render: %u us, Show: %u us\n", static_cast<unsigned>(controller.getRenderMicros()),
+                  static_cast<unsigned>(controller.getShowMicros()));
+  }
+  delay(10);
+}
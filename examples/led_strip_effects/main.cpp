@@ -11,6 +11,34 @@
 using espmods::led::LedStrip;
 using espmods::led::LedEffect;
 using espmods::led::LedEffectConfig;
+using espmods::led::LedEffectContext;
+using espmods::led::LedEffectRegistry;
+using espmods::led::LedEffectType;
+
+// Custom effect: a single dot chasing along the strip.
+// Its state lives in a block the strip allocates per segment.
+struct ChaseState {
+  uint16_t position;
+};
+
+size_t chaseStateSize(uint16_t) {
+  return sizeof(ChaseState);
+}
+
+bool renderChase(LedEffectContext& context, void* state) {
+  if (!context.stepDue(context.config().speed)) {
+    return false;
+  }
+  ChaseState& chase = *static_cast<ChaseState*>(state);
+  uint32_t color = context.config().primaryColor;
+  context.fill(RgbColor(0, 0, 0));
+  context.setPixel(chase.position, RgbColor(color >> 16, color >> 8, color));
+  chase.position = (chase.position + 1) % context.length();
+  return true;
+}
+
+const LedEffectType kChaseEffect = {"Chase", chaseStateSize, nullptr, renderChase};
+LedEffect chaseEffect;
 
 // Create LED strip instance
 // Pin 2, 50 LEDs, brightness 128
@@ -20,6 +48,9 @@ void setup() {
   Serial.begin(115200);
   Serial.println("LedStrip Example Starting...");
   
+  // Register application effects before using them
+  chaseEffect = LedEffectRegistry::add(kChaseEffect);
+  
   // Initialize the LED strip
   ledStrip.begin();
   
@@ -58,6 +89,13 @@ void setup() {
   config.intensity = 100;
   config.speed = 50;
   ledStrip.setEffect(config);
+  delay(5000);
+  
+  // Example 9: Custom registered effect
+  config.effect = chaseEffect;
+  config.primaryColor = 0x00FF88;
+  config.speed = 30;
+  ledStrip.setEffect(config);
   
   Serial.println("Setup complete - effects will cycle automatically in loop()");
 }
@@ -0,0 +1,60 @@
+/*
+ * LedTimeline Example
+ *
+ * Plays a show from a binary timeline instead of a delay() chain. A short
+ * cue list is compiled into flash; a longer show with pixel frames is
+ * streamed from LittleFS (/show.ledt) when present. Timelines can be
+ * produced with the reference encoder in extras/host/LedTimelineEncoder.h.
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <espmods/led.hpp>
+
+using espmods::led::FixedLedStrip;
+using espmods::led::LedTimeline;
+using espmods::led::LedTimelineFileSource;
+using espmods::led::LedTimelineMemorySource;
+
+// 'LEDT' v1, 60 pixels: crossfade transitions, rainbow, then colour
+// keyframes (orange, blue) with 1.5 s fades, then the end after 4 s
+const uint8_t kCueTimeline[] = {
+    'L', 'E', 'D', 'T', 1, 0, 60, 0,
+    0x00, 0x03, 3, 0xA0, 0x06,                              // Transition: Crossfade, 800 ms
+    0x00, 0x01, 0xFF, 9, 0, 0, 0, 0, 0, 0, 0x88, 0x27, 255, 0,  // Effect: Rainbow, 5000 ms
+    0xA0, 0x1F, 0x04, 0xFF, 0x44, 0x00, 0xDC, 0x0B,         // +4000 ms Color: 0xFF4400, 1500 ms fade
+    0xB8, 0x17, 0x04, 0x00, 0x00, 0xFF, 0xDC, 0x0B,         // +3000 ms Color: 0x0000FF, 1500 ms fade
+    0xA0, 0x1F, 0x00,                                       // +4000 ms End
+};
+
+FixedLedStrip<60> ledStrip(2);
+
+LedTimelineMemorySource cueSource(kCueTimeline, sizeof(kCueTimeline));
+LedTimeline cues(cueSource);
+
+File showFile;
+LedTimelineFileSource<File> showSource(showFile);
+LedTimeline show(showSource);
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("LedTimeline Example Starting...");
+
+  ledStrip.begin();
+  ledStrip.off();
+  ledStrip.startRenderTask();
+
+  if (LittleFS.begin() && (showFile = LittleFS.open("/show.ledt", "r"))) {
+    show.setLoop(true);
+    ledStrip.playTimeline(show);
+    Serial.println("Playing /show.ledt");
+  } else {
+    cues.setLoop(true);
+    ledStrip.playTimeline(cues);
+    Serial.println("Playing built-in cues");
+  }
+}
+
+void loop() {
+  delay(100);
+}
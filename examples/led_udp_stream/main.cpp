@@ -0,0 +1,61 @@
+/*
+ * LedStrip UDP Stream Example
+ *
+ * Drives the strip from a show controller (xLights, Jinx!, WLED sync,
+ * ...) over DDP on port 4048. Packets are decoded on the AsyncUDP task
+ * straight into the strip's stream buffer and a finished frame wakes the
+ * render task on the other core. The strip falls back to its rainbow two
+ * seconds after the controller stops sending.
+ *
+ * For E1.31 use NetPixelReceiver::Protocol::E131 with unicast output from
+ * the controller, starting at universe 1 (170 pixels per universe).
+ */
+
+#include <Arduino.h>
+#include <espmods/core.hpp>
+#include <espmods/led.hpp>
+#include <espmods/network.hpp>
+
+using espmods::core::LogSerial;
+using espmods::led::FixedLedStrip;
+using espmods::network::NetPixelReceiver;
+using espmods::network::NetWifiOta;
+using espmods::network::NetworkConfig;
+
+NetWifiOta netModule;
+FixedLedStrip<300> ledStrip(2);
+NetPixelReceiver pixelReceiver(ledStrip);
+
+void setup() {
+  Serial.begin(115200);
+  LogSerial.begin(Serial, "UdpStream");
+
+  ledStrip.begin();
+  ledStrip.rainbow();
+  ledStrip.startRenderTask();
+
+  NetworkConfig config;
+  config.wifiSsid = "YourWiFiSSID";        // Replace with your WiFi SSID
+  config.wifiPassword = "YourWiFiPassword"; // Replace with your WiFi password
+  config.deviceHostname = "led-stream";
+  netModule.begin(config);
+}
+
+void loop() {
+  netModule.loop();
+
+  if (netModule.isWifiConnected() && !pixelReceiver.isListening()) {
+    pixelReceiver.begin(NetPixelReceiver::Protocol::Ddp, 2000);
+  }
+
+  static uint32_t lastReport = 0;
+  if (millis() - lastReport > 10000) {
+    lastReport = millis();
+    const auto& stats = pixelReceiver.getStats();
+    LogSerial.printf("Stream: %u packets, %u frames, %u lost, %u late, %u not shown\n",
+                     static_cast<unsigned>(stats.packets), static_cast<unsigned>(stats.frames),
+                     static_cast<unsigned>(stats.lost), static_cast<unsigned>(stats.late),
+                     static_cast<unsigned>(ledStrip.getStreamFramesDropped()));
+  }
+  delay(1);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+// Reference encoder for the LedTimeline binary format (see
+// src/led/LedTimeline.h). Host-only: it builds the whole timeline in a
+// std::vector, which is then written to a file or a C array for flashing.
+
+#include <led/LedEffect.h>
+#include <led/LedStrip.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace espmods::host {
+
+class LedTimelineEncoder {
+ public:
+  explicit LedTimelineEncoder(uint16_t pixelCount) : pixelCount_(pixelCount) {
+    const uint8_t header[] = {'L', 'E', 'D', 'T', led::LedTimeline::kVersion, 0};
+    data_.assign(header, header + sizeof(header));
+    put16(pixelCount);
+  }
+
+  const std::vector<uint8_t>& data() const { return data_; }
+
+  void effect(uint32_t delayMs, uint8_t segment, const led::LedEffectConfig& config) {
+    record(delayMs, led::LedTimeline::Op::Effect);
+    data_.push_back(segment);
+    data_.push_back(static_cast<uint8_t>(config.effect));
+    put24(config.primaryColor);
+    put24(config.secondaryColor);
+    putVarint(config.speed);
+    data_.push_back(config.intensity);
+    data_.push_back(config.reverse ? 1 : 0);
+  }
+
+  void layout(uint32_t delayMs, const led::LedSegment* segments, uint8_t count) {
+    record(delayMs, led::LedTimeline::Op::Layout);
+    data_.push_back(count);
+    for (uint8_t s = 0; s < count; s++) {
+      putVarint(segments[s].start);
+      putVarint(segments[s].length);
+      data_.push_back(segments[s].effect.reverse ? 1 : 0);
+    }
+  }
+
+  void transition(uint32_t delayMs, led::LedTransition type, uint32_t durationMs) {
+    record(delayMs, led::LedTimeline::Op::Transition);
+    data_.push_back(static_cast<uint8_t>(type));
+    putVarint(durationMs);
+  }
+
+  void color(uint32_t delayMs, uint32_t rgb, uint32_t fadeMs) {
+    record(delayMs, led::LedTimeline::Op::Color);
+    put24(rgb);
+    putVarint(fadeMs);
+  }
+
+  void brightness(uint32_t delayMs, uint8_t value) {
+    record(delayMs, led::LedTimeline::Op::Brightness);
+    data_.push_back(value);
+  }
+
+  /**
+   * Pixel frame as a delta against previous (nullptr for a key frame):
+   * unchanged pixels become skips, equal neighbours repeats, the rest literals.
+   */
+  void frame(uint32_t delayMs, const RgbColor* pixels, const RgbColor* previous) {
+    record(delayMs, led::LedTimeline::Op::Frame);
+    uint16_t i = 0;
+    while (i < pixelCount_) {
+      uint16_t j = i;
+      if (previous != nullptr && pixels[i] == previous[i]) {
+        while (j < pixelCount_ && j - i < kMaxRun && pixels[j] == previous[j]) {
+          j++;
+        }
+        run(kSkip, j - i);
+      } else if (i + 1 < pixelCount_ && pixels[i + 1] == pixels[i]) {
+        while (j < pixelCount_ && j - i < kMaxRun && pixels[j] == pixels[i]) {
+          j++;
+        }
+        run(kRepeat, j - i);
+        putColor(pixels[i]);
+      } else {
+        // Literal until a skip or repeat would start
+        j++;
+        while (j < pixelCount_ && j - i < kMaxRun && !(previous != nullptr && pixels[j] == previous[j]) &&
+               !(j + 1 < pixelCount_ && pixels[j + 1] == pixels[j])) {
+          j++;
+        }
+        run(kLiteral, j - i);
+        for (uint16_t k = i; k < j; k++) {
+          putColor(pixels[k]);
+        }
+      }
+      i = j;
+    }
+  }
+
+  void end(uint32_t delayMs) { record(delayMs, led::LedTimeline::Op::End); }
+
+ private:
+  static constexpr uint8_t kSkip = 0;
+  static constexpr uint8_t kRepeat = 1;
+  static constexpr uint8_t kLiteral = 2;
+  static constexpr uint16_t kMaxRun = 64;
+
+  void record(uint32_t delayMs, led::LedTimeline::Op op) {
+    putVarint(delayMs);
+    data_.push_back(static_cast<uint8_t>(op));
+  }
+
+  void run(uint8_t type, uint16_t length) { data_.push_back(static_cast<uint8_t>(type << 6 | (length - 1))); }
+
+  void putColor(const RgbColor& color) {
+    data_.push_back(color.R);
+    data_.push_back(color.G);
+    data_.push_back(color.B);
+  }
+
+  void put16(uint16_t value) {
+    data_.push_back(value & 0xFF);
+    data_.push_back(value >> 8);
+  }
+
+  void put24(uint32_t rgb) {
+    data_.push_back((rgb >> 16) & 0xFF);
+    data_.push_back((rgb >> 8) & 0xFF);
+    data_.push_back(rgb & 0xFF);
+  }
+
+  void putVarint(uint32_t value) {
+    while (value >= 0x80) {
+      data_.push_back(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    data_.push_back(static_cast<uint8_t>(value));
+  }
+
+  uint16_t pixelCount_;
+  std::vector<uint8_t> data_;
+};
+
+}  // namespace espmods::host
@@ -0,0 +1,454 @@
+/*
+ * Host-side LedStrip/LedRing simulator and frame-time benchmark
+ *
+ * Renders every LedEffect across a range of strip lengths against the stub
+ * NeoPixelBusLg and reports the cost per frame and per pixel. The simulated
+ * clock advances one 60 fps frame per update(), so time-based effects
+ * animate as they would on the device. Rows marked '*' use a
+ * FixedLedStrip<300> with static buffers. Audio-reactive effects are fed
+ * a synthetic 120 bpm mic signal, one analysis frame per 32 ms. A strip
+ * and a ring built from one LedPixelPool are checked against heap-built
+ * twins, including a pool without room; the exit code reports a mismatch.
+ *
+ * Usage:
+ *   led_bench                    full table for all effects and sizes
+ *   led_bench --dither           same, with temporal dithering enabled
+ *   led_bench --preview <effect> print a few frames as ANSI colour blocks
+ */
+
+#include <Arduino.h>
+#include <espmods/led.hpp>
+#include <led/LedMath.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using espmods::audio::MicDetectionResult;
+using espmods::audio::MicResultChannel;
+using espmods::led::FixedLedStrip;
+using espmods::led::LedController;
+using espmods::led::LedEffect;
+using espmods::led::LedEffectConfig;
+using espmods::led::LedLevels;
+using espmods::led::LedOutput;
+using espmods::led::LedPixelPool;
+using espmods::led::LedRing;
+using espmods::led::LedStrip;
+using espmods::led::LedTransition;
+
+namespace {
+
+constexpr uint32_t kFrameMs = 16;
+constexpr uint16_t kSizes[] = {10, 50, 150, 300, 600, 1000, 2000};
+constexpr double kMinSampleNs = 50e6;  // Sample each case for at least 50 ms
+constexpr uint32_t kMicFrameMs = 32;    // 512 samples at 16 kHz
+constexpr uint16_t kPoolStripPixels = 150;
+constexpr uint16_t kPoolRingPixels = 24;
+
+bool ditherOutput = false;
+
+struct EffectCase {
+  const char* name;
+  LedEffectConfig config;
+};
+
+LedEffectConfig makeConfig(LedEffect effect, uint32_t primary, uint32_t secondary, uint32_t speed,
+                           uint8_t intensity = 255) {
+  LedEffectConfig config;
+  config.effect = effect;
+  config.primaryColor = primary;
+  config.secondaryColor = secondary;
+  config.speed = speed;
+  config.intensity = intensity;
+  return config;
+}
+
+const EffectCase kEffects[] = {
+    {"Off", makeConfig(LedEffect::Off, 0, 0, 1000)},
+    {"SolidColor", makeConfig(LedEffect::SolidColor, 0xFF4400, 0, 1000)},
+    {"Pulse", makeConfig(LedEffect::Pulse, 0xFF4400, 0, 2000)},
+    {"GradientPulse", makeConfig(LedEffect::GradientPulse, 0xFF0000, 0x0000FF, 3000)},
+    {"RandomFlicker", makeConfig(LedEffect::RandomFlicker, 0xFF4400, 0, 50, 80)},
+    {"Strobe", makeConfig(LedEffect::Strobe, 0xFFFFFF, 0, 100)},
+    {"ColorWave", makeConfig(LedEffect::ColorWave, 0xFF0000, 0x0000FF, 3000)},
+    {"Fire", makeConfig(LedEffect::Fire, 0xFF4400, 0xFF0000, 16, 128)},
+    {"Lightning", makeConfig(LedEffect::Lightning, 0xFFFFFF, 0, 2000)},
+    {"Rainbow", makeConfig(LedEffect::Rainbow, 0, 0, 5000)},
+    {"Sparkle", makeConfig(LedEffect::Sparkle, 0xFFFFFF, 0, 100, 20)},
+};
+
+const EffectCase kAudioEffects[] = {
+    {"VuMeter", makeConfig(LedEffect::VuMeter, 0x00FF00, 0xFF0000, 1500, 160)},
+    {"BeatPulse", makeConfig(LedEffect::BeatPulse, 0xFFFFFF, 0x000020, 300, 160)},
+};
+
+// Kick every 16 mic frames (~120 bpm) decaying into a low noise floor
+MicDetectionResult syntheticMicFrame(uint32_t sequence) {
+  MicDetectionResult result;
+  result.frameValid = true;
+  result.rms = 0.01f + 0.25f * std::pow(0.6f, static_cast<float>(sequence % 16));
+  result.sequence = sequence;
+  result.captureMicros = micros();
+  return result;
+}
+
+// Push a mic frame when the simulated clock crosses a mic frame boundary
+void feedMic(MicResultChannel& channel, uint32_t& sequence) {
+  if (millis() / kMicFrameMs != sequence) {
+    sequence = millis() / kMicFrameMs;
+    channel.push(syntheticMicFrame(sequence));
+  }
+}
+
+double nowNs() {
+  using namespace std::chrono;
+  return static_cast<double>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+void printRow(const char* name, uint16_t pixels, uint32_t frames, double elapsedNs, double shownPercent) {
+  double perFrame = elapsedNs / frames;
+  std::printf("%-16s %6u %12.0f %10.2f %12.0f %7.1f\n", name, pixels, perFrame, perFrame / pixels,
+              1e9 / perFrame, shownPercent);
+}
+
+void runStrip(LedStrip& strip, const char* name, const EffectCase& effect) {
+  strip.seedRandom(1);
+  strip.setDithering(ditherOutput);
+  strip.setTargetFps(0);
+  strip.begin();
+  strip.setEffect(effect.config);
+
+  uint32_t frames = 0;
+  double start = nowNs();
+  double elapsed = 0;
+  while (elapsed < kMinSampleNs) {
+    for (int i = 0; i < 64; i++) {
+      espmods::host::advanceMillis(kFrameMs);
+      strip.update();
+    }
+    frames += 64;
+    elapsed = nowNs() - start;
+  }
+  uint32_t shown = strip.getFramesShown();
+  printRow(name, strip.getLength(), frames, elapsed, 100.0 * shown / (shown + strip.getFramesSkipped()));
+}
+
+void benchStrip(const EffectCase& effect, uint16_t pixels) {
+  randomSeed(1);
+  espmods::host::setMillis(0);
+  LedStrip strip(0, pixels, 128);
+  runStrip(strip, effect.name, effect);
+}
+
+// Same effects on a compile-time sized strip with static buffers
+void benchFixedStrip(const EffectCase& effect) {
+  static char name[32];
+  std::snprintf(name, sizeof(name), "%s*", effect.name);
+  randomSeed(1);
+  espmods::host::setMillis(0);
+  FixedLedStrip<300> strip(0);
+  runStrip(strip, name, effect);
+}
+
+// Four strips on separate outputs driven by one controller
+void benchController() {
+  espmods::host::setMillis(0);
+  FixedLedStrip<150, NeoGrbFeature, NeoEsp32I2s0X8Ws2812xMethod> strip0(0);
+  FixedLedStrip<150, NeoGrbFeature, NeoEsp32I2s0X8Ws2812xMethod> strip1(1);
+  FixedLedStrip<150, NeoGrbFeature, NeoEsp32Rmt0Ws2812xMethod> strip2(2);
+  FixedLedStrip<150, NeoGrbFeature, NeoEsp32Rmt1Ws2812xMethod> strip3(3);
+  LedController controller;
+  controller.addStrip(strip0);
+  controller.addStrip(strip1);
+  controller.addStrip(strip2);
+  controller.addStrip(strip3);
+  controller.setTargetFps(0);
+  controller.begin();
+  strip0.rainbow();
+  strip1.colorWave(0xFF0000, 0x0000FF);
+  strip2.fire();
+  strip3.pulseColor(0xFF4400);
+
+  uint32_t frames = 0;
+  double start = nowNs();
+  double elapsed = 0;
+  while (elapsed < kMinSampleNs) {
+    for (int i = 0; i < 64; i++) {
+      espmods::host::advanceMillis(kFrameMs);
+      controller.update();
+    }
+    frames += 64;
+    elapsed = nowNs() - start;
+  }
+  printRow("Controller 4x150", 600, frames, elapsed, 100.0);
+}
+
+// Audio-reactive effects fed through a MicResultChannel; the latency is
+// measured from the synthetic frame's capture time to Show()
+void benchAudio(const EffectCase& effect, uint16_t pixels) {
+  espmods::host::setMillis(0);
+  LedStrip strip(0, pixels, 128);
+  MicResultChannel channel;
+  strip.setAudioSource(&channel);
+  strip.setTargetFps(0);
+  strip.begin();
+  strip.setEffect(effect.config);
+
+  uint32_t sequence = 0;
+  uint32_t frames = 0;
+  double start = nowNs();
+  double elapsed = 0;
+  while (elapsed < kMinSampleNs) {
+    for (int i = 0; i < 64; i++) {
+      espmods::host::advanceMillis(kFrameMs);
+      feedMic(channel, sequence);
+      strip.update();
+    }
+    frames += 64;
+    elapsed = nowNs() - start;
+  }
+  uint32_t shown = strip.getFramesShown();
+  printRow(effect.name, pixels, frames, elapsed, 100.0 * shown / (shown + strip.getFramesSkipped()));
+  if (pixels == 300) {
+    std::printf("%-16s mic-to-Show() latency: last %u us, max %u us\n", effect.name,
+                strip.getAudioLatencyMicros(), strip.getMaxAudioLatencyMicros());
+  }
+}
+
+// brushing false leaves progress static: loop() ticks the scheduler but
+// only renders when the ratio changes once a second
+void benchRing(uint16_t pixels, bool brushing) {
+  randomSeed(1);
+  espmods::host::setMillis(0);
+  LedRing ring(0, pixels, 128);
+  ring.seedRandom(1);
+  ring.begin();
+  ring.setGradientColors(0x00FF00, 0x0000FF);
+  ring.setBrushingActive(brushing);
+
+  // Progress advances once a second as in the app; loop() animates the
+  // brushing highlight in between
+  const uint32_t totalSeconds = 120;
+  uint32_t lastSeconds = UINT32_MAX;
+  uint32_t frames = 0;
+  double start = nowNs();
+  double elapsed = 0;
+  while (elapsed < kMinSampleNs) {
+    for (int i = 0; i < 64; i++) {
+      espmods::host::advanceMillis(kFrameMs);
+      uint32_t elapsedSeconds = (millis() / 1000) % totalSeconds;
+      if (elapsedSeconds != lastSeconds) {
+        lastSeconds = elapsedSeconds;
+        ring.showProgress(elapsedSeconds, totalSeconds);
+      }
+      ring.loop();
+    }
+    frames += 64;
+    elapsed = nowNs() - start;
+  }
+  uint32_t shown = ring.getFramesShown();
+  printRow(brushing ? "LedRing progress" : "LedRing static", pixels, frames, elapsed, 100.0 * shown / (shown + ring.getFramesSkipped()));
+}
+
+// Keeps the last levels shown, so two devices' output can be compared
+class CaptureOutput : public LedOutput {
+ public:
+  explicit CaptureOutput(uint16_t count) : pending_(count), shown_(count) {}
+  void begin() override {}
+  void setPixel(uint16_t index, const LedLevels& levels) override { pending_[index] = levels; }
+  void show() override { shown_ = pending_; }
+
+  bool sameAs(const CaptureOutput& other) const {
+    for (size_t i = 0; i < shown_.size(); i++) {
+      const LedLevels& a = shown_[i];
+      const LedLevels& b = other.shown_[i];
+      if (a.R != b.R || a.G != b.G || a.B != b.B || a.W != b.W) {
+        return false;
+      }
+    }
+    return shown_.size() == other.shown_.size();
+  }
+
+ private:
+  std::vector<LedLevels> pending_;
+  std::vector<LedLevels> shown_;
+};
+
+// A pooled strip and ring render the same frames as heap-built twins
+// (effect change with a crossfade through the pooled transition buffers,
+// ring progress with the brushing highlight)
+bool renderMatches(LedStrip& strip, CaptureOutput& stripOut, LedRing& ring, CaptureOutput& ringOut) {
+  CaptureOutput refStripOut(kPoolStripPixels), refRingOut(kPoolRingPixels);
+  LedStrip refStrip(refStripOut, kPoolStripPixels, 128, nullptr);
+  LedRing refRing(refRingOut, kPoolRingPixels, 128, nullptr);
+  espmods::host::setMillis(0);
+  for (LedStrip* s : {&strip, &refStrip}) {
+    s->seedRandom(1);
+    s->setTargetFps(0);
+    s->begin();
+    s->colorWave(0xFF0000, 0x0000FF);
+    s->setTransition(LedTransition::Crossfade, 300);
+  }
+  for (LedRing* r : {&ring, &refRing}) {
+    r->seedRandom(1);
+    r->begin();
+    r->setGradientColors(0x00FF00, 0x0000FF);
+    r->setBrushingActive(true);
+  }
+  for (uint32_t frame = 0; frame < 200; frame++) {
+    espmods::host::advanceMillis(kFrameMs);
+    if (frame == 50) {
+      strip.rainbow();
+      refStrip.rainbow();
+    }
+    uint32_t seconds = millis() / 1000;
+    for (LedRing* r : {&ring, &refRing}) {
+      r->showProgress(seconds, 120);
+      r->loop();
+    }
+    strip.update();
+    refStrip.update();
+    if (!stripOut.sameAs(refStripOut) || !ringOut.sameAs(refRingOut)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool checkPool() {
+  CaptureOutput stripOut(kPoolStripPixels), ringOut(kPoolRingPixels);
+
+  // Sized for both: frames and transition buffers, then the ring's tables
+  size_t capacity = LedStrip::poolPixels(kPoolStripPixels) + LedRing::poolPixels(kPoolRingPixels);
+  LedPixelPool pool(capacity);
+  LedStrip strip(stripOut, kPoolStripPixels, 128, pool);
+  size_t stripUsed = pool.getUsed();
+  LedRing ring(ringOut, kPoolRingPixels, 128, pool);
+  bool accounting = stripUsed == 4u * kPoolStripPixels && pool.getUsed() == capacity &&
+                    pool.getCapacity() == capacity;
+  bool rendering = renderMatches(strip, stripOut, ring, ringOut);
+  std::printf("LedPixelPool %zu pixels, strip %u + ring %u: accounting %s, rendering %s\n", capacity,
+              kPoolStripPixels, kPoolRingPixels, accounting ? "ok" : "FAILED", rendering ? "ok" : "FAILED");
+
+  // Room for the strip's frames only: the strip allocates its transition
+  // buffers on first use and the ring falls back to the heap
+  CaptureOutput shortStripOut(kPoolStripPixels), shortRingOut(kPoolRingPixels);
+  LedPixelPool shortPool(LedStrip::poolPixels(kPoolStripPixels, false));
+  LedStrip shortStrip(shortStripOut, kPoolStripPixels, 128, shortPool);
+  LedRing shortRing(shortRingOut, kPoolRingPixels, 128, shortPool);
+  bool shortAccounting = shortPool.getUsed() == shortPool.getCapacity();
+  bool shortRendering = renderMatches(shortStrip, shortStripOut, shortRing, shortRingOut);
+
+  // No room at all: everything comes from the heap
+  CaptureOutput emptyStripOut(kPoolStripPixels), emptyRingOut(kPoolRingPixels);
+  LedPixelPool emptyPool(0);
+  LedStrip emptyStrip(emptyStripOut, kPoolStripPixels, 128, emptyPool);
+  LedRing emptyRing(emptyRingOut, kPoolRingPixels, 128, emptyPool);
+  bool emptyRendering =
+      emptyPool.getUsed() == 0 && renderMatches(emptyStrip, emptyStripOut, emptyRing, emptyRingOut);
+  bool exhausted = shortAccounting && shortRendering && emptyRendering;
+  std::printf("LedPixelPool exhausted: heap fallback %s\n", exhausted ? "ok" : "FAILED");
+  return accounting && rendering && exhausted;
+}
+
+// Cost of one draw from Arduino random() versus LedRandom. On the host
+// random() is a cheap LCG; on the ESP32 it reads the hardware RNG and
+// divides, so the device saving is larger than shown here.
+void benchRandom() {
+  constexpr uint32_t kDraws = 1u << 24;
+  volatile uint32_t sink = 0;
+
+  double start = nowNs();
+  for (uint32_t i = 0; i < kDraws; i++) {
+    sink = sink + random(0, 255);
+  }
+  double arduinoNs = (nowNs() - start) / kDraws;
+
+  espmods::led::LedRandom rng(1);
+  start = nowNs();
+  for (uint32_t i = 0; i < kDraws; i++) {
+    sink = sink + rng.below(255);
+  }
+  double fastNs = (nowNs() - start) / kDraws;
+
+  std::printf("\nPRNG draw: random() %.2f ns, LedRandom %.2f ns\n", arduinoNs, fastNs);
+  // The previous flicker/fire/confetti paths drew 1-3 values per pixel
+  std::printf("Saving for 300 pixels at 3 draws/pixel: %.0f ns per frame\n",
+              300 * 3 * (arduinoNs - fastNs));
+}
+
+void preview(const EffectCase& effect) {
+  espmods::host::setMillis(0);
+  LedStrip strip(0, 60, 255);
+  MicResultChannel channel;
+  strip.setAudioSource(&channel);
+  strip.setTargetFps(0);
+  strip.begin();
+  strip.setEffect(effect.config);
+  uint32_t sequence = 0;
+  for (int frame = 0; frame < 40; frame++) {
+    espmods::host::advanceMillis(50);
+    feedMic(channel, sequence);
+    strip.update();
+    for (uint16_t i = 0; i < strip.getLength(); i++) {
+      RgbColor c = strip.getPixelColor(i);
+      std::printf("\x1b[48;2;%u;%u;%um ", c.R, c.G, c.B);
+    }
+    std::printf("\x1b[0m\n");
+  }
+}
+
+void preview(const char* name) {
+  for (const EffectCase& effect : kEffects) {
+    if (std::strcmp(effect.name, name) == 0) {
+      preview(effect);
+      return;
+    }
+  }
+  for (const EffectCase& effect : kAudioEffects) {
+    if (std::strcmp(effect.name, name) == 0) {
+      preview(effect);
+      return;
+    }
+  }
+  std::printf("Unknown effect '%s'\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc == 3 && std::strcmp(argv[1], "--preview") == 0) {
+    preview(argv[2]);
+    return 0;
+  }
+
+  ditherOutput = argc == 2 && std::strcmp(argv[1], "--dither") == 0;
+  std::printf("Render path: %s%s\n", ESPMODS_LED_FIXED_POINT ? "fixed-point" : "float",
+              ditherOutput ? ", dithered output" : "");
+  std::printf("%-16s %6s %12s %10s %12s %7s\n", "effect", "pixels", "ns/frame", "ns/pixel", "frames/s",
+              "shown%");
+  for (const EffectCase& effect : kEffects) {
+    for (uint16_t pixels : kSizes) {
+      benchStrip(effect, pixels);
+    }
+  }
+  for (const EffectCase& effect : kEffects) {
+    benchFixedStrip(effect);
+  }
+  for (const EffectCase& effect : kAudioEffects) {
+    for (uint16_t pixels : kSizes) {
+      benchAudio(effect, pixels);
+    }
+  }
+  benchController();
+  for (uint16_t pixels : kSizes) {
+    benchRing(pixels, true);
+  }
+  for (uint16_t pixels : kSizes) {
+    benchRing(pixels, false);
+  }
+  benchRandom();
+  return checkPool() ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+/*
+ * MicI2S analysis benchmark
+ *
+ * Feeds MicI2S a synthetic 16 kHz microphone signal (a brushing-like tone
+ * with harmonics over noise, then noise alone) through the stubbed I2S
+ * driver and times update(), one 512-sample analysis frame per call. The
+ * same frames also run through a reference copy of the analysis as it
+ * was before the window and Goertzel coefficient tables: a cosf() per
+ * sample for the Hann window and per bin for the coefficients on every
+ * frame, with the sequential six-state Goertzel loop. Reports the cost
+ * per frame of both and the largest difference in bin power, ratio,
+ * tonality and RMS, which must stay within float rounding of the reference.
+ * Also times a MicI2S configured with the maximum number of bins, and
+ * checks the capture task's handoff to update(): after a stalled consumer
+ * misses frames it must get the newest one back.
+ */
+
+#include <Arduino.h>
+#include <audio/MicI2S.h>
+#include <driver/i2s.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using espmods::audio::GoertzelBank;
+using espmods::audio::MicDetectionResult;
+using espmods::audio::MicI2S;
+using espmods::audio::MicResultChannel;
+using espmods::audio::MicResultMailbox;
+
+namespace {
+
+constexpr size_t kFrameSamples = 512;
+constexpr size_t kBins = 6;
+constexpr size_t kSignalFrames = 64;
+constexpr float kSampleRate = 16000.0f;
+constexpr double kMinSampleNs = 200e6;
+constexpr float kMaxBinError = 5e-4f;    // Of the frame's strongest bin
+constexpr float kMaxRatioError = 1e-2f;  // Quiet bins divide the ratio
+
+double nowNs() {
+  using namespace std::chrono;
+  return static_cast<double>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+// 24-bit samples left justified in 32-bit words, as the INMP441 delivers them
+std::vector<int32_t> makeSignal() {
+  std::minstd_rand rng(1);
+  std::normal_distribution<float> noise(0.0f, 0.002f);
+  std::vector<int32_t> words(kSignalFrames * kFrameSamples);
+  for (size_t n = 0; n < words.size(); n++) {
+    float t = n / kSampleRate;
+    bool tone = (n / kFrameSamples) % 16 < 10;
+    float sample = noise(rng);
+    if (tone) {
+      sample += 0.05f * sinf(TWO_PI * 240.0f * t) + 0.02f * sinf(TWO_PI * 480.0f * t) +
+                0.01f * sinf(TWO_PI * 210.0f * t);
+    }
+    int32_t raw24 = static_cast<int32_t>(lroundf(constrain(sample, -1.0f, 0.9999f) * 8388608.0f));
+    words[n] = static_cast<int32_t>(static_cast<uint32_t>(raw24) << 8);
+  }
+  return words;
+}
+
+struct SignalPlayer {
+  const std::vector<int32_t>* words;
+  size_t position = 0;
+};
+
+size_t playSignal(int32_t* words, size_t count, void* context) {
+  // Stands in for a DMA buffer copy, so it should cost next to nothing
+  SignalPlayer& player = *static_cast<SignalPlayer*>(context);
+  size_t copied = 0;
+  while (copied < count) {
+    size_t run = min(count - copied, player.words->size() - player.position);
+    std::memcpy(words + copied, player.words->data() + player.position, run * sizeof(int32_t));
+    copied += run;
+    player.position = (player.position + run) % player.words->size();
+  }
+  return count;
+}
+
+// The analysis before the tables: conversion, running window sums and
+// Goertzel with the window and coefficients computed on every frame
+class ReferenceAnalysis {
+ public:
+  void frame(const int32_t* words, MicDetectionResult& result) {
+    for (size_t i = 0; i < kFrameSamples; i++) {
+      float sample = static_cast<float>(words[i] >> 8) / 8388608.0f;
+      frame_[i] = sample;
+      if (windowFill_ < kWindowSize) {
+        ++windowFill_;
+      } else {
+        float old = window_[windowIndex_];
+        windowSum_ -= old;
+        windowSumSquares_ -= static_cast<double>(old) * old;
+      }
+      window_[windowIndex_] = sample;
+      windowSum_ += sample;
+      windowSumSquares_ += static_cast<double>(sample) * sample;
+      windowIndex_ = (windowIndex_ + 1) % kWindowSize;
+    }
+
+    static constexpr float kFrequencies[kBins] = {210.0f, 240.0f, 270.0f, 480.0f, 120.0f, 390.0f};
+    float coeff[kBins], s1[kBins] = {}, s2[kBins] = {};
+    for (size_t b = 0; b < kBins; b++) {
+      coeff[b] = 2.0f * cosf(static_cast<float>(TWO_PI) * kFrequencies[b] / kSampleRate);
+    }
+    double sumSquares = 0.0;
+    for (size_t n = 0; n < kFrameSamples; n++) {
+      float sample = frame_[n];
+      sumSquares += static_cast<double>(sample) * sample;
+      float phase = static_cast<float>(n) / static_cast<float>(kFrameSamples - 1);
+      float windowed = sample * 0.5f * (1.0f - cosf(static_cast<float>(TWO_PI) * phase));
+      for (size_t b = 0; b < kBins; b++) {
+        float s = windowed + coeff[b] * s1[b] - s2[b];
+        s2[b] = s1[b];
+        s1[b] = s;
+      }
+    }
+    for (size_t b = 0; b < kBins; b++) {
+      result.bins[b] = max(0.0f, s1[b] * s1[b] + s2[b] * s2[b] - coeff[b] * s1[b] * s2[b]);
+    }
+    const float* bins = result.bins;
+    float harmonicSum = bins[0] + bins[1] + bins[2];
+    float maxHarmonic = max(bins[0], max(bins[1], bins[2]));
+    result.ratio = (harmonicSum + 0.5f * bins[3]) / (bins[4] + bins[5] + 1e-6f);
+    result.tonality = maxHarmonic / (harmonicSum + 1e-6f);
+    result.rms = sqrtf(static_cast<float>(sumSquares / kFrameSamples));
+    double mean = windowSum_ / windowFill_;
+    windowedRms_ = sqrtf(static_cast<float>(max(0.0, windowSumSquares_ / windowFill_ - mean * mean)));
+  }
+
+  float windowedRms() const { return windowedRms_; }
+
+ private:
+  static constexpr size_t kWindowSize = 1024;
+  float frame_[kFrameSamples] = {};
+  float window_[kWindowSize] = {};
+  size_t windowIndex_ = 0;
+  size_t windowFill_ = 0;
+  double windowSum_ = 0.0;
+  double windowSumSquares_ = 0.0;
+  float windowedRms_ = 0.0f;
+};
+
+float relativeError(float value, float reference) {
+  float scale = max(fabsf(reference), 1e-12f);
+  return fabsf(value - reference) / scale;
+}
+
+// A consumer that missed kMissed frames: the mailbox (capture task to
+// update()) hands back the newest, the channel (LED consumer) keeps the
+// first kCapacity and counts the rest as dropped, as documented
+bool checkHandoff() {
+  constexpr uint32_t kMissed = 10;
+  MicResultMailbox mailbox;
+  MicResultChannel channel;
+  MicDetectionResult result;
+  for (uint32_t sequence = 1; sequence <= kMissed; sequence++) {
+    result.sequence = sequence;
+    mailbox.publish(result);
+    channel.push(result);
+  }
+  MicDetectionResult taken;
+  bool newest = mailbox.take(taken) && taken.sequence == kMissed && !mailbox.take(taken);
+  result.sequence = kMissed + 1;
+  mailbox.publish(result);
+  newest = newest && mailbox.take(taken) && taken.sequence == kMissed + 1;
+
+  MicDetectionResult popped;
+  bool dropNew = channel.popLatest(popped) && popped.sequence == MicResultChannel::kCapacity &&
+                 channel.dropped() == kMissed - MicResultChannel::kCapacity;
+  std::printf("handoff after %u missed frames: mailbox newest %s, channel drop-new %s\n", kMissed,
+              newest ? "ok" : "FAILED", dropNew ? "ok" : "FAILED");
+  return newest && dropNew;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<int32_t> signal = makeSignal();
+
+  // Reference cost per frame; results feed a sink so none of it is dead
+  volatile float sink = 0.0f;
+  ReferenceAnalysis reference;
+  MicDetectionResult expected;
+  uint32_t frames = 0;
+  double start = nowNs();
+  double referenceNs = 0;
+  while (referenceNs < kMinSampleNs) {
+    for (size_t f = 0; f < kSignalFrames; f++) {
+      reference.frame(&signal[f * kFrameSamples], expected);
+      sink = sink + expected.ratio + expected.rms + reference.windowedRms();
+    }
+    frames += kSignalFrames;
+    referenceNs = nowNs() - start;
+  }
+  referenceNs /= frames;
+
+  // MicI2S through the stubbed driver, one frame per update()
+  SignalPlayer player{&signal};
+  espmods::host::setI2sSource(playSignal, &player);
+  MicI2S mic(GPIO_NUM_NC, GPIO_NUM_NC, GPIO_NUM_NC);
+  mic.begin();
+  frames = 0;
+  start = nowNs();
+  double micNs = 0;
+  while (micNs < kMinSampleNs) {
+    for (size_t f = 0; f < kSignalFrames; f++) {
+      sink = sink + mic.update(0.0f, 0.0f).ratio + mic.windowedRms();
+    }
+    frames += kSignalFrames;
+    micNs = nowNs() - start;
+  }
+  micNs /= frames;
+
+  // Same pipeline with every bin in use
+  MicI2S wide(GPIO_NUM_NC, GPIO_NUM_NC, GPIO_NUM_NC);
+  espmods::audio::MicBin wideBins[MicI2S::kMaxBins];
+  for (size_t b = 0; b < MicI2S::kMaxBins; b++) {
+    wideBins[b].frequency = 100.0f + 100.0f * b;
+    wideBins[b].numeratorWeight = b % 2 == 0 ? 1.0f : 0.0f;
+    wideBins[b].denominatorWeight = b % 2 == 0 ? 0.0f : 1.0f;
+    wideBins[b].tonal = b % 2 == 0;
+  }
+  wide.setBins(wideBins, MicI2S::kMaxBins);
+  wide.begin();
+  frames = 0;
+  start = nowNs();
+  double wideNs = 0;
+  while (wideNs < kMinSampleNs) {
+    for (size_t f = 0; f < kSignalFrames; f++) {
+      sink = sink + wide.update(0.0f, 0.0f).ratio;
+    }
+    frames += kSignalFrames;
+    wideNs = nowNs() - start;
+  }
+  wideNs /= frames;
+
+  // Same frames side by side; bin errors are relative to the frame's strongest bin
+  ReferenceAnalysis check;
+  player.position = 0;
+  float binError = 0.0f;
+  float ratioError = 0.0f;
+  float tonalityError = 0.0f;
+  float rmsError = 0.0f;
+  for (size_t f = 0; f < kSignalFrames; f++) {
+    check.frame(&signal[f * kFrameSamples], expected);
+    const MicDetectionResult& result = mic.update(0.0f, 0.0f);
+    float peak = *std::max_element(expected.bins, expected.bins + kBins);
+    for (size_t b = 0; b < kBins; b++) {
+      binError = max(binError, fabsf(result.bins[b] - expected.bins[b]) / max(peak, 1e-12f));
+    }
+    ratioError = max(ratioError, relativeError(result.ratio, expected.ratio));
+    tonalityError = max(tonalityError, relativeError(result.tonality, expected.tonality));
+    rmsError = max(rmsError, relativeError(result.rms, expected.rms));
+  }
+
+  std::printf("%zu-sample frames, %zu bins, %.1f ms of audio per frame\n", kFrameSamples, kBins,
+              1000.0f * kFrameSamples / kSampleRate);
+  std::printf("%-26s %10s %10s\n", "analysis", "ns/frame", "ns/sample");
+  std::printf("%-26s %10.0f %10.2f\n", "reference (cosf per frame)", referenceNs, referenceNs / kFrameSamples);
+  std::printf("%-26s %10.0f %10.2f\n", (std::string("MicI2S::update() ") + GoertzelBank::kernelName()).c_str(),
+              micNs, micNs / kFrameSamples);
+  std::printf("%-26s %10.0f %10.2f\n", ("  with " + std::to_string(MicI2S::kMaxBins) + " bins").c_str(), wideNs,
+              wideNs / kFrameSamples);
+  std::printf("speedup x%.2f\n", referenceNs / micNs);
+  bool ok = binError <= kMaxBinError && ratioError <= kMaxRatioError && tonalityError <= kMaxRatioError &&
+            rmsError <= kMaxRatioError;
+  std::printf("max error vs reference: bins %.2e of peak, ratio %.2e, tonality %.2e, rms %.2e  %s\n", binError,
+              ratioError, tonalityError, rmsError, ok ? "ok" : "FAILED");
+  bool handoff = checkHandoff();
+  return ok && handoff ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+/*
+ * UDP loopback benchmark for LedStreamReceiver
+ *
+ * A sender thread streams DDP or E1.31 frames over 127.0.0.1 to a
+ * receiver thread that decodes each datagram into a LedStrip's stream
+ * buffer, while the main thread renders the strip the way its render
+ * task would. Each protocol runs twice: flat out, for packets/s and
+ * decode cost, then paced at 40 fps for the jitter of frame arrival and
+ * the latency from sending a frame's first packet to publishing it.
+ * Every published frame is checked against the pattern the sender wrote,
+ * and a reordered packet sequence is fed without the socket to check
+ * that late packets never overwrite a newer frame.
+ */
+
+#include <Arduino.h>
+#include <espmods/led.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using espmods::led::LedStreamReceiver;
+using espmods::led::LedStrip;
+
+namespace {
+
+constexpr uint16_t kPixels = 1000;           // 3 DDP packets or 6 universes per frame
+constexpr uint16_t kDdpPixelsPerPacket = 480;  // 1440 data bytes, as common senders use
+constexpr uint16_t kSyncUniverse = 7999;
+constexpr uint32_t kBlastMs = 1000;
+constexpr uint32_t kPacedFps = 40;
+constexpr uint32_t kPacedFrames = 80;
+
+enum class Protocol { Ddp, E131, E131Sync };
+
+double nowNs() {
+  using namespace std::chrono;
+  return static_cast<double>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t nowMs() {
+  return static_cast<uint32_t>(nowNs() / 1e6);
+}
+
+void put16(uint8_t* out, uint16_t value) {
+  out[0] = value >> 8;
+  out[1] = value & 0xFF;
+}
+
+void put32(uint8_t* out, uint32_t value) {
+  put16(out, value >> 16);
+  put16(out + 2, value & 0xFFFF);
+}
+
+// Pixel 0 carries the frame number, the rest a pattern that moves per frame
+void fillFrame(std::vector<uint8_t>& rgb, uint32_t frame) {
+  for (uint16_t i = 0; i < kPixels; i++) {
+    rgb[3 * i] = static_cast<uint8_t>(i + frame);
+    rgb[3 * i + 1] = static_cast<uint8_t>(i * 3);
+    rgb[3 * i + 2] = static_cast<uint8_t>(frame * 7);
+  }
+  rgb[0] = frame >> 8;
+  rgb[1] = frame & 0xFF;
+  rgb[2] = 0x5A;
+}
+
+bool checkFrame(const LedStrip& strip, uint32_t frame) {
+  std::vector<uint8_t> rgb(3 * kPixels);
+  fillFrame(rgb, frame);
+  for (uint16_t i = 0; i < kPixels; i++) {
+    RgbColor color = strip.getPixelColor(i);
+    if (color.R != rgb[3 * i] || color.G != rgb[3 * i + 1] || color.B != rgb[3 * i + 2]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ddpPacket(uint8_t* out, uint8_t sequence, bool push, uint32_t offset, const uint8_t* rgb,
+                 uint16_t length) {
+  out[0] = 0x40 | (push ? 0x01 : 0x00);
+  out[1] = sequence;
+  out[2] = 0x0B;  // RGB, 8 bits per channel
+  out[3] = 1;
+  put32(out + 4, offset);
+  put16(out + 8, length);
+  memcpy(out + 10, rgb, length);
+  return 10 + length;
+}
+
+void e131Root(uint8_t* out, size_t length, uint32_t vector) {
+  static const uint8_t kPacketId[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+  memset(out, 0, length);
+  put16(out, 0x0010);
+  memcpy(out + 4, kPacketId, sizeof(kPacketId));
+  put16(out + 16, 0x7000 | (length - 16));
+  put32(out + 18, vector);
+}
+
+size_t e131Packet(uint8_t* out, uint16_t universe, uint8_t sequence, uint16_t syncUniverse, const uint8_t* rgb,
+                  uint16_t channels) {
+  size_t length = 126 + channels;
+  e131Root(out, length, 0x00000004);
+  put16(out + 38, 0x7000 | (length - 38));
+  put32(out + 40, 0x00000002);
+  memcpy(out + 44, "stream_bench", 12);
+  out[108] = 100;  // Priority
+  put16(out + 109, syncUniverse);
+  out[111] = sequence;
+  put16(out + 113, universe);
+  put16(out + 115, 0x7000 | (length - 115));
+  out[117] = 0x02;
+  out[118] = 0xA1;
+  put16(out + 121, 1);
+  put16(out + 123, channels + 1);
+  memcpy(out + 126, rgb, channels);
+  return length;
+}
+
+size_t e131Sync(uint8_t* out, uint8_t sequence, uint16_t syncUniverse) {
+  e131Root(out, 49, 0x00000008);
+  put16(out + 38, 0x7000 | 11);
+  put32(out + 40, 0x00000001);
+  out[44] = sequence;
+  put16(out + 45, syncUniverse);
+  return 49;
+}
+
+struct Sender {
+  Protocol protocol;
+  int socket;
+  sockaddr_in target;
+  std::vector<uint8_t> rgb = std::vector<uint8_t>(3 * kPixels);
+  uint8_t packet[1500] = {};
+  uint8_t ddpSequence = 0;
+  uint8_t e131Sequence = 0;
+  uint32_t packets = 0;
+
+  void send(size_t length) {
+    sendto(socket, packet, length, 0, reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+    packets++;
+  }
+
+  void frame(uint32_t number) {
+    fillFrame(rgb, number);
+    if (protocol == Protocol::Ddp) {
+      for (uint16_t p = 0; p < kPixels; p += kDdpPixelsPerPacket) {
+        uint16_t count = std::min<uint16_t>(kDdpPixelsPerPacket, kPixels - p);
+        ddpSequence = ddpSequence % 15 + 1;
+        send(ddpPacket(packet, ddpSequence, p + count == kPixels, 3 * p, rgb.data() + 3 * p, 3 * count));
+      }
+      return;
+    }
+    uint16_t sync = protocol == Protocol::E131Sync ? kSyncUniverse : 0;
+    e131Sequence++;
+    for (uint16_t p = 0, universe = 1; p < kPixels; p += LedStreamReceiver::kE131PixelsPerUniverse, universe++) {
+      uint16_t count = std::min<uint16_t>(LedStreamReceiver::kE131PixelsPerUniverse, kPixels - p);
+      send(e131Packet(packet, universe, e131Sequence, sync, rgb.data() + 3 * p, 3 * count));
+    }
+    if (sync != 0) {
+      send(e131Sync(packet, e131Sequence, sync));
+    }
+  }
+};
+
+struct Result {
+  uint32_t packetsSent = 0;
+  double seconds = 0;
+  double decodeNs = 0;           // Per received datagram
+  std::vector<double> arrivals;  // Frame commits, ns
+  std::vector<double> latencies; // Send of a frame's first packet to publish, ns
+  LedStreamReceiver::Stats stats;
+  uint32_t shown = 0;
+  uint32_t dropped = 0;
+  bool ok = true;
+};
+
+Result run(Protocol protocol, bool paced) {
+  int rx = socket(AF_INET, SOCK_DGRAM, 0);
+  int tx = socket(AF_INET, SOCK_DGRAM, 0);
+  int bufferSize = 4 << 20;
+  setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+  timeval timeout = {0, 50000};
+  setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(rx, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  socklen_t addressLength = sizeof(address);
+  getsockname(rx, reinterpret_cast<sockaddr*>(&address), &addressLength);
+
+  LedStrip strip(0, kPixels, 255);
+  strip.setTargetFps(60);
+  strip.begin();
+  LedStreamReceiver receiver(strip);
+  receiver.begin();
+  espmods::host::setMillis(nowMs());
+  strip.update();  // The renderer accepts the stream
+
+  Result result;
+  uint32_t frameCount = paced ? kPacedFrames : 1u << 20;
+  std::vector<std::atomic<double>> sendTimes(paced ? kPacedFrames : 0);
+  std::atomic<bool> sending(true);
+  std::atomic<bool> receiving(true);
+
+  std::thread receiverThread([&] {
+    uint8_t packet[1500];
+    double decodeNs = 0;
+    uint32_t datagrams = 0;
+    while (receiving.load()) {
+      ssize_t length = recv(rx, packet, sizeof(packet), 0);
+      if (length <= 0) {
+        continue;
+      }
+      uint32_t frames = receiver.getStats().frames;
+      double start = nowNs();
+      if (protocol == Protocol::Ddp) {
+        receiver.handleDdp(packet, length, nowMs());
+      } else {
+        receiver.handleE131(packet, length, nowMs());
+      }
+      double end = nowNs();
+      decodeNs += end - start;
+      datagrams++;
+      if (receiver.getStats().frames != frames) {
+        result.arrivals.push_back(end);
+      }
+    }
+    result.decodeNs = datagrams > 0 ? decodeNs / datagrams : 0;
+  });
+
+  Sender sender{protocol, tx, address};
+  double start = nowNs();
+  std::thread senderThread([&] {
+    double period = 1e9 / kPacedFps;
+    for (uint32_t f = 0; f < frameCount; f++) {
+      if (paced) {
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+            std::chrono::nanoseconds(static_cast<int64_t>(start + f * period))));
+      } else if (nowNs() - start > kBlastMs * 1e6) {
+        break;
+      }
+      if (paced) {
+        sendTimes[f].store(nowNs());
+      }
+      sender.frame(f);
+    }
+    sending.store(false);
+  });
+
+  // Render loop: update() skips the frame-rate wait when a frame is pending
+  RgbColor lastTag;
+  double idleSince = 0;
+  for (;;) {
+    espmods::host::setMillis(nowMs());
+    strip.update();
+    RgbColor tag = strip.getPixelColor(0);
+    if (tag.B == 0x5A && tag != lastTag) {
+      lastTag = tag;
+      uint32_t frame = tag.R << 8 | tag.G;
+      result.shown++;
+      if (paced && frame < kPacedFrames) {
+        result.latencies.push_back(nowNs() - sendTimes[frame].load());
+      }
+      result.ok &= checkFrame(strip, frame);
+    }
+    if (sending.load()) {
+      idleSince = 0;
+    } else if (idleSince == 0) {
+      idleSince = nowNs();
+    } else if (nowNs() - idleSince > 100e6) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  result.seconds = (nowNs() - start) / 1e9 - 0.1;
+  senderThread.join();
+  receiving.store(false);
+  receiverThread.join();
+
+  result.packetsSent = sender.packets;
+  result.stats = receiver.getStats();
+  result.dropped = strip.getStreamFramesDropped();
+  receiver.end();
+  close(rx);
+  close(tx);
+  return result;
+}
+
+void stats(const std::vector<double>& values, double& mean, double& peak) {
+  mean = 0;
+  peak = 0;
+  for (double v : values) {
+    mean += v;
+    peak = std::max(peak, v);
+  }
+  mean = values.empty() ? 0 : mean / values.size();
+}
+
+void report(const char* name, Protocol protocol) {
+  Result blast = run(protocol, false);
+  std::printf("%-10s flat out %9.0f pkts/s %8.0f frames/s %6.0f ns/pkt  lost %u late %u dropped %u/%u  %s\n",
+              name, blast.stats.packets / blast.seconds, blast.stats.frames / blast.seconds, blast.decodeNs,
+              blast.stats.lost, blast.stats.late, blast.dropped, blast.stats.frames, blast.ok ? "ok" : "FAILED");
+
+  Result paced = run(protocol, true);
+  // Jitter: deviation of frame arrival intervals from the send period
+  std::vector<double> jitter;
+  for (size_t i = 1; i < paced.arrivals.size(); i++) {
+    jitter.push_back(std::fabs(paced.arrivals[i] - paced.arrivals[i - 1] - 1e9 / kPacedFps));
+  }
+  double jitterMean;
+  double jitterMax;
+  double latencyMean;
+  double latencyMax;
+  stats(jitter, jitterMean, jitterMax);
+  stats(paced.latencies, latencyMean, latencyMax);
+  std::printf("%-10s %2u fps   %9.0f pkts/s %8.0f frames/s  jitter %5.0f/%5.0f us  latency %5.0f/%5.0f us  "
+              "shown %u/%u  %s\n",
+              name, kPacedFps, paced.stats.packets / paced.seconds, paced.stats.frames / paced.seconds,
+              jitterMean / 1e3, jitterMax / 1e3, latencyMean / 1e3, latencyMax / 1e3, paced.shown, kPacedFrames,
+              paced.ok ? "ok" : "FAILED");
+}
+
+// Frame 1 arrives with a late packet of frame 0 in its middle and a
+// duplicate push at the end; only frame 1 may reach the strip
+bool checkReorder() {
+  LedStrip strip(0, kPixels, 255);
+  strip.setTargetFps(0);
+  strip.begin();
+  LedStreamReceiver receiver(strip);
+  receiver.begin();
+  espmods::host::setMillis(1000);
+  strip.update();
+
+  std::vector<std::vector<uint8_t>> packets;
+  std::vector<uint8_t> rgb(3 * kPixels);
+  uint8_t sequence = 0;
+  for (uint32_t f = 0; f < 2; f++) {
+    fillFrame(rgb, f);
+    for (uint16_t p = 0; p < kPixels; p += kDdpPixelsPerPacket) {
+      uint16_t count = std::min<uint16_t>(kDdpPixelsPerPacket, kPixels - p);
+      std::vector<uint8_t> packet(10 + 3 * count);
+      sequence = sequence % 15 + 1;
+      ddpPacket(packet.data(), sequence, p + count == kPixels, 3 * p, rgb.data() + 3 * p, 3 * count);
+      packets.push_back(packet);
+    }
+  }
+  const size_t order[] = {0, 1, 2, 3, 4, 1, 5, 5};
+  for (size_t i : order) {
+    receiver.handleDdp(packets[i].data(), packets[i].size(), 1000);
+  }
+  strip.update();
+  const LedStreamReceiver::Stats& stats = receiver.getStats();
+  return stats.late == 2 && stats.frames == 2 && checkFrame(strip, 1);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%u pixels over UDP loopback; jitter and latency are mean/max\n", kPixels);
+  report("DDP", Protocol::Ddp);
+  report("E1.31", Protocol::E131);
+  report("E1.31 sync", Protocol::E131Sync);
+  std::printf("\nLate and duplicate packets: %s\n", checkReorder() ? "ok" : "FAILED");
+  return 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+// Minimal Arduino core for building the LED and audio modules on a Linux
+// host. millis() is a simulated clock driven by the benchmark, micros()
+// is real monotonic time so the modules' own profiling counters work.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+
+using std::max;
+using std::min;
+
+#define PI 3.1415926535897932384626433832795
+#define TWO_PI 6.283185307179586476925286766559
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Enough of Arduino's String for log lines
+class String {
+ public:
+  String(const char* text = "") : text_(text) {}
+  String(double value, unsigned int decimals) : text_(std::to_string(value)) {
+    size_t dot = text_.find('.');
+    if (dot != std::string::npos) {
+      text_.resize(decimals > 0 ? dot + 1 + decimals : dot);
+    }
+  }
+
+  String operator+(const String& other) const { return String((text_ + other.text_).c_str()); }
+  friend String operator+(const char* left, const String& right) { return String(left) + right; }
+  const char* c_str() const { return text_.c_str(); }
+
+ private:
+  std::string text_;
+};
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+namespace espmods::host {
+
+// Simulated clock used by millis()
+void setMillis(uint32_t now);
+void advanceMillis(uint32_t delta);
+
+}  // namespace espmods::host
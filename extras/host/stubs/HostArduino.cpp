@@ -0,0 +1,43 @@
+#include <Arduino.h>
+
+#include <chrono>
+#include <random>
+
+namespace {
+uint32_t simulatedMillis = 0;
+std::minstd_rand randomEngine(1);
+}  // namespace
+
+uint32_t millis() { return simulatedMillis; }
+
+uint32_t micros() {
+  using namespace std::chrono;
+  static const auto start = steady_clock::now();
+  return static_cast<uint32_t>(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
+
+void delay(uint32_t ms) { simulatedMillis += ms; }
+
+long random(long howBig) {
+  if (howBig <= 0) {
+    return 0;
+  }
+  return static_cast<long>(randomEngine() % static_cast<unsigned long>(howBig));
+}
+
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) {
+    return howSmall;
+  }
+  return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) { randomEngine.seed(seed); }
+
+namespace espmods::host {
+
+void setMillis(uint32_t now) { simulatedMillis = now; }
+
+void advanceMillis(uint32_t delta) { simulatedMillis += delta; }
+
+}  // namespace espmods::host
@@ -0,0 +1,27 @@
+#include <driver/i2s.h>
+
+namespace {
+espmods::host::I2sSource i2sSource = nullptr;
+void* i2sContext = nullptr;
+}  // namespace
+
+esp_err_t i2s_driver_install(i2s_port_t, const i2s_config_t*, int, void*) { return ESP_OK; }
+
+esp_err_t i2s_set_pin(i2s_port_t, const i2s_pin_config_t*) { return ESP_OK; }
+
+esp_err_t i2s_set_clk(i2s_port_t, uint32_t, i2s_bits_per_sample_t, i2s_channel_t) { return ESP_OK; }
+
+esp_err_t i2s_read(i2s_port_t, void* dest, size_t size, size_t* bytesRead, TickType_t) {
+  size_t words = i2sSource != nullptr ? i2sSource(static_cast<int32_t*>(dest), size / sizeof(int32_t), i2sContext) : 0;
+  *bytesRead = words * sizeof(int32_t);
+  return ESP_OK;
+}
+
+namespace espmods::host {
+
+void setI2sSource(I2sSource source, void* context) {
+  i2sSource = source;
+  i2sContext = context;
+}
+
+}  // namespace espmods::host
@@ -0,0 +1,104 @@
+#pragma once
+
+// Host stand-in for NeoPixelBusLg: keeps the pixel buffer in memory and
+// counts Show() calls so the simulator can inspect and preview frames.
+// Luminance and the gamma method are accepted but not applied.
+
+#include <Arduino.h>
+
+struct RgbColor {
+  RgbColor() : R(0), G(0), B(0) {}
+  RgbColor(uint8_t r, uint8_t g, uint8_t b) : R(r), G(g), B(b) {}
+  explicit RgbColor(uint8_t brightness) : R(brightness), G(brightness), B(brightness) {}
+
+  bool operator==(const RgbColor& other) const {
+    return R == other.R && G == other.G && B == other.B;
+  }
+  bool operator!=(const RgbColor& other) const { return !(*this == other); }
+
+  uint8_t R;
+  uint8_t G;
+  uint8_t B;
+};
+
+struct RgbwColor {
+  RgbwColor() : R(0), G(0), B(0), W(0) {}
+  RgbwColor(uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) : R(r), G(g), B(b), W(w) {}
+
+  uint8_t R;
+  uint8_t G;
+  uint8_t B;
+  uint8_t W;
+};
+
+struct Rgb48Color {
+  Rgb48Color() : R(0), G(0), B(0) {}
+  Rgb48Color(uint16_t r, uint16_t g, uint16_t b) : R(r), G(g), B(b) {}
+
+  uint16_t R;
+  uint16_t G;
+  uint16_t B;
+};
+
+struct Rgbw64Color {
+  Rgbw64Color() : R(0), G(0), B(0), W(0) {}
+  Rgbw64Color(uint16_t r, uint16_t g, uint16_t b, uint16_t w = 0) : R(r), G(g), B(b), W(w) {}
+
+  uint16_t R;
+  uint16_t G;
+  uint16_t B;
+  uint16_t W;
+};
+
+struct NeoGrbFeature { typedef RgbColor ColorObject; };
+struct NeoGrbwFeature { typedef RgbwColor ColorObject; };
+struct NeoGrb48Feature { typedef Rgb48Color ColorObject; };
+struct NeoGrbw64Feature { typedef Rgbw64Color ColorObject; };
+struct NeoEsp32I2s0800KbpsMethod {};
+struct NeoEsp32I2s0X8Ws2812xMethod {};
+struct NeoEsp32I2s1X8Ws2812xMethod {};
+struct NeoEsp32Rmt0Ws2812xMethod {};
+struct NeoEsp32Rmt1Ws2812xMethod {};
+struct NeoEsp32Rmt2Ws2812xMethod {};
+struct NeoEsp32Rmt3Ws2812xMethod {};
+struct NeoGammaTableMethod {};
+struct NeoGammaNullMethod {};
+
+template <typename T_COLOR_FEATURE, typename T_METHOD, typename T_GAMMA = NeoGammaTableMethod>
+class NeoPixelBusLg {
+ public:
+  typedef typename T_COLOR_FEATURE::ColorObject ColorObject;
+
+  NeoPixelBusLg(uint16_t countPixels, uint8_t /*pin*/)
+      : count_(countPixels), pixels_(new ColorObject[countPixels]) {}
+  ~NeoPixelBusLg() { delete[] pixels_; }
+
+  NeoPixelBusLg(const NeoPixelBusLg&) = delete;
+  NeoPixelBusLg& operator=(const NeoPixelBusLg&) = delete;
+
+  void Begin() {}
+  void Show() { showCount_++; }
+  bool CanShow() const { return true; }
+
+  void SetPixelColor(uint16_t index, ColorObject color) {
+    if (index < count_) {
+      pixels_[index] = color;
+    }
+  }
+  ColorObject GetPixelColor(uint16_t index) const {
+    return index < count_ ? pixels_[index] : ColorObject();
+  }
+  void ClearTo(ColorObject color) {
+    for (uint16_t i = 0; i < count_; i++) {
+      pixels_[i] = color;
+    }
+  }
+
+  uint16_t PixelCount() const { return count_; }
+  uint32_t ShowCount() const { return showCount_; }
+
+ private:
+  uint16_t count_;
+  ColorObject* pixels_;
+  uint32_t showCount_ = 0;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+// Stand-in for the core module on the host: found before include/ so the
+// audio sources build without the serial and web log. Log lines are
+// discarded so the benchmarks time the modules, not the console.
+
+#include <Arduino.h>
+
+namespace espmods::core {
+
+struct HostLog {
+  size_t println(const String&) { return 0; }
+  size_t println(const char*) { return 0; }
+};
+
+inline HostLog LogSerial;
+
+}  // namespace espmods::core
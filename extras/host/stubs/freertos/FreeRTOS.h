@@ -0,0 +1,37 @@
+#pragma once
+
+// FreeRTOS surface used by the modules. Task creation reports failure on
+// the host, so everything runs inline from the benchmark loop.
+
+#include <cstdint>
+
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdPASS 1
+#define pdFAIL 0
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+#define portMAX_DELAY (static_cast<TickType_t>(0xFFFFFFFFu))
+
+inline BaseType_t xPortGetCoreID() { return 1; }
+
+inline BaseType_t xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t, void*,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+  if (handle != nullptr) {
+    *handle = nullptr;
+  }
+  return pdFAIL;
+}
+
+inline void vTaskDelete(TaskHandle_t) {}
+inline TickType_t xTaskGetTickCount() { return 0; }
+inline void vTaskDelay(TickType_t) {}
+inline void vTaskDelayUntil(TickType_t*, TickType_t) {}
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+
+#define pdTRUE 1
+#define pdFALSE 0
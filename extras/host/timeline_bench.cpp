@@ -0,0 +1,185 @@
+/*
+ * LedTimeline encoder/player round trip and benchmark
+ *
+ * Records a few seconds of LedStrip effects as pixel frames, encodes them
+ * with the reference encoder (skip/repeat/literal runs against the
+ * previous frame) and plays the result back through LedStrip from a
+ * memory source. Reports the compressed size against raw RGB frames, the
+ * playback cost per frame, and checks every shown frame against the
+ * recording, including ticks slower than the frame rate where late
+ * frames are decoded back to back.
+ */
+
+#include <Arduino.h>
+#include <espmods/led.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "LedTimelineEncoder.h"
+
+using espmods::host::LedTimelineEncoder;
+using espmods::led::LedEffect;
+using espmods::led::LedEffectConfig;
+using espmods::led::LedStrip;
+using espmods::led::LedTimeline;
+using espmods::led::LedTimelineMemorySource;
+
+namespace {
+
+constexpr uint16_t kPixels = 300;
+constexpr uint32_t kFrameMs = 33;      // ~30 fps show
+constexpr uint32_t kShowFrames = 300;  // 10 s
+constexpr double kMinSampleNs = 50e6;
+
+double nowNs() {
+  using namespace std::chrono;
+  return static_cast<double>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+using Frame = std::vector<RgbColor>;
+
+// Effect output sampled once per show frame
+std::vector<Frame> recordEffect(LedEffect effect, uint32_t primary, uint32_t speed, uint8_t intensity) {
+  espmods::host::setMillis(0);
+  LedStrip strip(0, kPixels, 255);
+  strip.seedRandom(1);
+  strip.setTargetFps(0);
+  strip.begin();
+  LedEffectConfig config;
+  config.effect = effect;
+  config.primaryColor = primary;
+  config.speed = speed;
+  config.intensity = intensity;
+  strip.setEffect(config);
+
+  std::vector<Frame> frames;
+  for (uint32_t f = 0; f < kShowFrames; f++) {
+    espmods::host::advanceMillis(kFrameMs);
+    strip.update();
+    Frame frame(kPixels);
+    for (uint16_t i = 0; i < kPixels; i++) {
+      frame[i] = strip.getPixelColor(i);
+    }
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+std::vector<uint8_t> encode(const std::vector<Frame>& frames) {
+  LedTimelineEncoder encoder(kPixels);
+  for (size_t f = 0; f < frames.size(); f++) {
+    // The first frame is a key frame; the rest are deltas
+    encoder.frame(f == 0 ? 0 : kFrameMs, frames[f].data(), f == 0 ? nullptr : frames[f - 1].data());
+  }
+  encoder.end(kFrameMs);
+  return encoder.data();
+}
+
+// Play at the given tick and compare the shown frame with the recording
+bool verify(const std::vector<uint8_t>& data, const std::vector<Frame>& frames, uint32_t tickMs) {
+  espmods::host::setMillis(1000);
+  LedStrip strip(0, kPixels, 255);
+  strip.setTargetFps(0);
+  strip.begin();
+  LedTimelineMemorySource source(data.data(), data.size());
+  LedTimeline timeline(source);
+  strip.playTimeline(timeline);
+  strip.update();  // Starts playback at t = 0
+
+  for (uint32_t t = tickMs; t < frames.size() * kFrameMs; t += tickMs) {
+    espmods::host::advanceMillis(tickMs);
+    strip.update();
+    const Frame& expected = frames[t / kFrameMs];
+    for (uint16_t i = 0; i < kPixels; i++) {
+      if (strip.getPixelColor(i) != expected[i]) {
+        std::printf("  mismatch at %u ms (tick %u ms), pixel %u\n", t, tickMs, i);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void benchShow(const char* name, const std::vector<Frame>& frames) {
+  std::vector<uint8_t> data = encode(frames);
+  size_t raw = frames.size() * kPixels * 3;
+
+  // One show frame per update(), looping over the timeline
+  espmods::host::setMillis(0);
+  LedStrip strip(0, kPixels, 255);
+  strip.setTargetFps(0);
+  strip.begin();
+  LedTimelineMemorySource source(data.data(), data.size());
+  LedTimeline timeline(source);
+  timeline.setLoop(true);
+  strip.playTimeline(timeline);
+  strip.update();
+
+  uint32_t updates = 0;
+  double start = nowNs();
+  double elapsed = 0;
+  while (elapsed < kMinSampleNs) {
+    for (int i = 0; i < 64; i++) {
+      espmods::host::advanceMillis(kFrameMs);
+      strip.update();
+    }
+    updates += 64;
+    elapsed = nowNs() - start;
+  }
+
+  bool ok = verify(data, frames, kFrameMs) && verify(data, frames, 16) && verify(data, frames, 100);
+  std::printf("%-10s %8zu %9zu %6.1f%% %10.0f %8.2f  %s\n", name, raw, data.size(), 100.0 * data.size() / raw,
+              elapsed / updates, elapsed / updates / kPixels, ok ? "ok" : "FAILED");
+}
+
+// Effect and colour keyframes only: a few bytes per cue
+void benchCues() {
+  LedTimelineEncoder encoder(kPixels);
+  LedEffectConfig config;
+  config.effect = LedEffect::Rainbow;
+  config.speed = 5000;
+  encoder.transition(0, espmods::led::LedTransition::Crossfade, 800);
+  encoder.effect(0, LedTimeline::kWholeStrip, config);
+  encoder.color(4000, 0xFF4400, 1500);
+  encoder.color(3000, 0x0000FF, 1500);
+  encoder.brightness(2000, 64);
+  config.effect = LedEffect::Fire;
+  config.primaryColor = 0xFF4400;
+  config.secondaryColor = 0xFF0000;
+  config.speed = 16;
+  config.intensity = 128;
+  encoder.effect(1000, LedTimeline::kWholeStrip, config);
+  encoder.end(5000);
+
+  std::vector<uint8_t> data = encoder.data();
+  espmods::host::setMillis(0);
+  LedStrip strip(0, kPixels, 128);
+  strip.setTargetFps(0);
+  strip.begin();
+  LedTimelineMemorySource source(data.data(), data.size());
+  LedTimeline timeline(source);
+  strip.playTimeline(timeline);
+  uint32_t frames = 0;
+  while (strip.isTimelinePlaying() && frames < 10000) {
+    espmods::host::advanceMillis(16);
+    strip.update();
+    frames++;
+  }
+  std::printf("\nCue timeline: 6 cues over %u ms in %zu bytes, ended after %u frames, brightness %u\n",
+              16 * frames, data.size(), frames, strip.getBrightness());
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%u pixels, %u frames at %u ms\n", kPixels, kShowFrames, kFrameMs);
+  std::printf("%-10s %8s %9s %7s %10s %8s\n", "show", "raw B", "encoded B", "ratio", "ns/frame", "ns/pixel");
+  benchShow("Fire", recordEffect(LedEffect::Fire, 0xFF4400, 16, 128));
+  benchShow("Sparkle", recordEffect(LedEffect::Sparkle, 0xFFFFFF, 100, 20));
+  benchShow("Strobe", recordEffect(LedEffect::Strobe, 0xFFFFFF, 200, 255));
+  benchShow("Rainbow", recordEffect(LedEffect::Rainbow, 0, 5000, 255));
+  benchCues();
+  return 0;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "audio/AudioDySv5w.h"
+#include "audio/GoertzelBank.h"
 #include "audio/MicI2S.h"
 
 namespace espmods {
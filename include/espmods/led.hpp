@@ -1,7 +1,14 @@
 #pragma once
 
+#include "led/FixedLedStrip.h"
+#include "led/LedController.h"
+#include "led/LedEffect.h"
+#include "led/LedOutput.h"
+#include "led/LedPixelPool.h"
 #include "led/LedRing.h"
+#include "led/LedStreamReceiver.h"
 #include "led/LedStrip.h"
+#include "led/LedTimeline.h"
 
 namespace espmods {
 namespace led {}
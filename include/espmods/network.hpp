@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include "network/NetPixelReceiver.h"
 #include "network/NetWifiOta.h"
 #include "network/NetworkConfig.h"
 #include "network/WidgetDashboard.h"
@@ -0,0 +1,211 @@
+#include "GoertzelBank.h"
+
+#include <math.h>
+
+#if ESPMODS_AUDIO_SIMD && defined(__SSE__)
+#include <xmmintrin.h>
+#define ESPMODS_GOERTZEL_SSE 1
+#elif ESPMODS_AUDIO_SIMD && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ESPMODS_GOERTZEL_NEON 1
+#endif
+
+namespace espmods::audio {
+namespace {
+constexpr float kTwoPi = 6.28318530717958647692f;
+}  // namespace
+
+bool GoertzelBank::setFrequencies(const float *frequencies, size_t count, float sampleRate) {
+  if (count > kMaxBins || sampleRate <= 0.0f) {
+    return false;
+  }
+  for (size_t i = 0; i < kMaxBins; ++i) {
+    // Unused bins in the last group run with a zero coefficient
+    coeff_[i] = i < count ? 2.0f * cosf(kTwoPi * frequencies[i] / sampleRate) : 0.0f;
+    s1_[i] = 0.0f;
+    s2_[i] = 0.0f;
+  }
+  count_ = count;
+  segment_ = 0;
+  return true;
+}
+
+void GoertzelBank::prepareCarry(size_t segment) {
+  // The free recurrence y[n] = c*y[n-1] - y[n-2] maps (y[n], y[n-1]) to
+  // y[n+m] = y[n]*U_m - y[n-1]*U_(m-1); U_m from the same recurrence in
+  // double, starting at U_-1 = 0 and U_0 = 1, for the float coefficient
+  for (size_t b = 0; b < count_; ++b) {
+    double c = coeff_[b];
+    double previous = 0.0;
+    double current = 1.0;
+    double beforePrevious = 0.0;
+    for (size_t m = 0; m < segment; ++m) {
+      double next = c * current - previous;
+      beforePrevious = previous;
+      previous = current;
+      current = next;
+    }
+    carryL_[b] = static_cast<float>(current);
+    carryL1_[b] = static_cast<float>(previous);
+    carryL2_[b] = static_cast<float>(beforePrevious);
+  }
+  segment_ = segment;
+}
+
+#if defined(ESPMODS_GOERTZEL_SSE)
+
+void GoertzelBank::runLanes(const float *interleaved, size_t steps) {
+  // Four bins per pass, each one vector of kLanes segment chains
+  for (size_t g = 0; g < count_; g += kLanes) {
+    __m128 c0 = _mm_set1_ps(coeff_[g]);
+    __m128 c1 = _mm_set1_ps(coeff_[g + 1]);
+    __m128 c2 = _mm_set1_ps(coeff_[g + 2]);
+    __m128 c3 = _mm_set1_ps(coeff_[g + 3]);
+    __m128 a0 = _mm_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+    __m128 b0 = a0, b1 = a0, b2 = a0, b3 = a0;
+    const float *x = interleaved;
+    for (size_t j = 0; j < steps; ++j, x += kLanes) {
+      __m128 sample = _mm_loadu_ps(x);
+      __m128 s0 = _mm_sub_ps(_mm_add_ps(sample, _mm_mul_ps(c0, a0)), b0);
+      __m128 s1 = _mm_sub_ps(_mm_add_ps(sample, _mm_mul_ps(c1, a1)), b1);
+      __m128 s2 = _mm_sub_ps(_mm_add_ps(sample, _mm_mul_ps(c2, a2)), b2);
+      __m128 s3 = _mm_sub_ps(_mm_add_ps(sample, _mm_mul_ps(c3, a3)), b3);
+      b0 = a0, b1 = a1, b2 = a2, b3 = a3;
+      a0 = s0, a1 = s1, a2 = s2, a3 = s3;
+    }
+    _mm_storeu_ps(laneS1_[g], a0);
+    _mm_storeu_ps(laneS1_[g + 1], a1);
+    _mm_storeu_ps(laneS1_[g + 2], a2);
+    _mm_storeu_ps(laneS1_[g + 3], a3);
+    _mm_storeu_ps(laneS2_[g], b0);
+    _mm_storeu_ps(laneS2_[g + 1], b1);
+    _mm_storeu_ps(laneS2_[g + 2], b2);
+    _mm_storeu_ps(laneS2_[g + 3], b3);
+  }
+}
+
+const char *GoertzelBank::kernelName() { return "SSE"; }
+
+#elif defined(ESPMODS_GOERTZEL_NEON)
+
+void GoertzelBank::runLanes(const float *interleaved, size_t steps) {
+  // Four bins per pass, each one vector of kLanes segment chains; separate
+  // multiply and add keep the rounding of the scalar kernel
+  for (size_t g = 0; g < count_; g += kLanes) {
+    float32x4_t c0 = vdupq_n_f32(coeff_[g]);
+    float32x4_t c1 = vdupq_n_f32(coeff_[g + 1]);
+    float32x4_t c2 = vdupq_n_f32(coeff_[g + 2]);
+    float32x4_t c3 = vdupq_n_f32(coeff_[g + 3]);
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = a0, a2 = a0, a3 = a0;
+    float32x4_t b0 = a0, b1 = a0, b2 = a0, b3 = a0;
+    const float *x = interleaved;
+    for (size_t j = 0; j < steps; ++j, x += kLanes) {
+      float32x4_t sample = vld1q_f32(x);
+      float32x4_t s0 = vsubq_f32(vaddq_f32(sample, vmulq_f32(c0, a0)), b0);
+      float32x4_t s1 = vsubq_f32(vaddq_f32(sample, vmulq_f32(c1, a1)), b1);
+      float32x4_t s2 = vsubq_f32(vaddq_f32(sample, vmulq_f32(c2, a2)), b2);
+      float32x4_t s3 = vsubq_f32(vaddq_f32(sample, vmulq_f32(c3, a3)), b3);
+      b0 = a0, b1 = a1, b2 = a2, b3 = a3;
+      a0 = s0, a1 = s1, a2 = s2, a3 = s3;
+    }
+    vst1q_f32(laneS1_[g], a0);
+    vst1q_f32(laneS1_[g + 1], a1);
+    vst1q_f32(laneS1_[g + 2], a2);
+    vst1q_f32(laneS1_[g + 3], a3);
+    vst1q_f32(laneS2_[g], b0);
+    vst1q_f32(laneS2_[g + 1], b1);
+    vst1q_f32(laneS2_[g + 2], b2);
+    vst1q_f32(laneS2_[g + 3], b3);
+  }
+}
+
+const char *GoertzelBank::kernelName() { return "NEON"; }
+
+#else
+
+// The lane kernel stays scalar on every compiler: the host benchmark then
+// measures what the ESP32 runs, and GCC 12's vectorizer miscompiles this
+// loop nest at -O2 (every lane state comes out zero)
+#if defined(__GNUC__) && !defined(__clang__)
+#define ESPMODS_GOERTZEL_SCALAR __attribute__((optimize("no-tree-vectorize")))
+#else
+#define ESPMODS_GOERTZEL_SCALAR
+#endif
+
+ESPMODS_GOERTZEL_SCALAR void GoertzelBank::runLanes(const float *interleaved, size_t steps) {
+  // One bin per pass with its kLanes chains in registers: four independent
+  // multiply-adds per sample fill the FPU pipeline that a single chain
+  // leaves waiting
+  for (size_t b = 0; b < count_; ++b) {
+    const float c = coeff_[b];
+    float s1[kLanes] = {};
+    float s2[kLanes] = {};
+    const float *x = interleaved;
+    for (size_t j = 0; j < steps; ++j, x += kLanes) {
+      for (size_t k = 0; k < kLanes; ++k) {
+        float s = x[k] + c * s1[k] - s2[k];
+        s2[k] = s1[k];
+        s1[k] = s;
+      }
+    }
+    for (size_t k = 0; k < kLanes; ++k) {
+      laneS1_[b][k] = s1[k];
+      laneS2_[b][k] = s2[k];
+    }
+  }
+}
+
+const char *GoertzelBank::kernelName() { return "scalar"; }
+
+#endif
+
+void GoertzelBank::joinLanes() {
+  // Carry the state across each following segment and add that segment's
+  // own response
+  for (size_t b = 0; b < count_; ++b) {
+    float s1 = laneS1_[b][0];
+    float s2 = laneS2_[b][0];
+    for (size_t k = 1; k < kLanes; ++k) {
+      float next1 = s1 * carryL_[b] - s2 * carryL1_[b] + laneS1_[b][k];
+      float next2 = s1 * carryL1_[b] - s2 * carryL2_[b] + laneS2_[b][k];
+      s1 = next1;
+      s2 = next2;
+    }
+    s1_[b] = s1;
+    s2_[b] = s2;
+  }
+}
+
+void GoertzelBank::process(const float *interleaved, size_t count) {
+  size_t segment = count / kLanes;
+  if (segment > 0) {
+    if (segment != segment_) {
+      prepareCarry(segment);
+    }
+    runLanes(interleaved, segment);
+    joinLanes();
+  } else {
+    for (size_t b = 0; b < count_; ++b) {
+      s1_[b] = 0.0f;
+      s2_[b] = 0.0f;
+    }
+  }
+  // Samples past the last full group continue the joined state in order
+  for (size_t n = segment * kLanes; n < count; ++n) {
+    for (size_t b = 0; b < count_; ++b) {
+      float s = interleaved[n] + coeff_[b] * s1_[b] - s2_[b];
+      s2_[b] = s1_[b];
+      s1_[b] = s;
+    }
+  }
+}
+
+float GoertzelBank::power(size_t bin) const {
+  if (bin >= count_) {
+    return 0.0f;
+  }
+  float power = s1_[bin] * s1_[bin] + s2_[bin] * s2_[bin] - coeff_[bin] * s1_[bin] * s2_[bin];
+  return power > 0.0f ? power : 0.0f;
+}
+
+}  // namespace espmods::audio
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Select the Goertzel kernel at build time:
+//   1 (default) - SSE or NEON vectors where the compiler offers them,
+//                 otherwise the scalar lane kernel
+//   0           - scalar lane kernel everywhere
+// Override with -DESPMODS_AUDIO_SIMD=0 to compare kernels on the host.
+#ifndef ESPMODS_AUDIO_SIMD
+#define ESPMODS_AUDIO_SIMD 1
+#endif
+
+namespace espmods::audio {
+
+/**
+ * @brief Goertzel filters for several frequency bins over one frame
+ *
+ * A single Goertzel recurrence is one long dependency chain, so the frame
+ * is split into kLanes consecutive segments that run as independent
+ * chains (one vector per bin with SSE/NEON, four scalar registers per bin
+ * otherwise, which keeps the ESP32's FPU busy between dependent
+ * operations). The recurrence is linear, so the segment states are then
+ * joined exactly by carrying each one across the following segments with
+ * precomputed Chebyshev factors. Results match the sequential filter to
+ * float rounding.
+ *
+ * process() reads the frame in lane-interleaved order: sample n of a
+ * count-sample frame sits at interleavedIndex(n, count). Writing samples
+ * there as they arrive avoids a reordering pass.
+ *
+ * Coefficients, lane factors and filter state are kept structure-of-arrays
+ * so each bin's values load as one vector.
+ */
+class GoertzelBank {
+ public:
+  static constexpr size_t kMaxBins = 16;
+  static constexpr size_t kLanes = 4;
+
+  /**
+   * @brief Set the bin frequencies; filter state is cleared
+   * @param frequencies Bin centre frequencies in Hz
+   * @param count Number of bins, up to kMaxBins
+   * @param sampleRate Sample rate in Hz
+   * @return false if count exceeds kMaxBins
+   */
+  bool setFrequencies(const float *frequencies, size_t count, float sampleRate);
+
+  /**
+   * @brief Number of bins
+   */
+  size_t size() const { return count_; }
+
+  /**
+   * @brief Run all bins over one frame, starting from zero state
+   * @param interleaved count samples in interleavedIndex() order
+   * @param count Frame length
+   */
+  void process(const float *interleaved, size_t count);
+
+  /**
+   * @brief Squared magnitude of a bin after process()
+   */
+  float power(size_t bin) const;
+
+  /**
+   * @brief Position of sample n in the layout process() reads
+   *
+   * Samples past the last full group of kLanes segments stay in place.
+   */
+  static constexpr size_t interleavedIndex(size_t n, size_t count) {
+    return n < count / kLanes * kLanes ? (n % (count / kLanes)) * kLanes + n / (count / kLanes) : n;
+  }
+
+  /**
+   * @brief Name of the compiled kernel ("SSE", "NEON" or "scalar")
+   */
+  static const char *kernelName();
+
+ private:
+  static_assert(kMaxBins % kLanes == 0, "Bins are processed in groups of kLanes");
+
+  void prepareCarry(size_t segment);
+  void runLanes(const float *interleaved, size_t steps);
+  void joinLanes();
+
+  // Structure of arrays; the carry factors move a state across one
+  // segment of L samples (Chebyshev polynomials of the second kind at c/2)
+  float coeff_[kMaxBins] = {};
+  float laneS1_[kMaxBins][kLanes] = {};
+  float laneS2_[kMaxBins][kLanes] = {};
+  float carryL_[kMaxBins] = {};         // U_L
+  float carryL1_[kMaxBins] = {};        // U_(L-1)
+  float carryL2_[kMaxBins] = {};        // U_(L-2)
+  float s1_[kMaxBins] = {};
+  float s2_[kMaxBins] = {};
+  size_t count_ = 0;
+  size_t segment_ = 0;                  // Segment length the carry factors are for
+};
+
+}  // namespace espmods::audio
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#include "GoertzelBank.h"
+
+namespace espmods::audio {
+
+/**
+ * @brief One Goertzel bin of the detection and its part in the ratio
+ *
+ * The frame ratio is the weighted sum of bin powers with numeratorWeight
+ * over the weighted sum with denominatorWeight. Tonality is the strongest
+ * tonal bin over the sum of the tonal bins.
+ */
+struct MicBin {
+  float frequency = 0.0f;          // Bin centre in Hz, below half the sample rate
+  float numeratorWeight = 0.0f;    // Weight in the ratio numerator
+  float denominatorWeight = 0.0f;  // Weight in the ratio denominator
+  bool tonal = false;              // Counted in the tonality measure
+};
+
+struct MicDetectionResult {
+  bool brushing = false;        // Current brushing state after debounce
+  bool frameValid = false;      // True when the most recent Goertzel frame ran
+  float rms = 0.0f;             // RMS of the latest frame
+  float ratio = 0.0f;           // Instantaneous spectral ratio for this frame
+  float ratioEma = 0.0f;        // Smoothed spectral ratio (EMA)
+  float tonality = 0.0f;        // Instantaneous tonality for this frame
+  float tonalityEma = 0.0f;     // Smoothed tonality (EMA)
+  float bins[GoertzelBank::kMaxBins] = {0.0f};  // Bin power in MicI2S::bins() order
+  uint8_t binCount = 0;         // Number of valid entries in bins
+  uint32_t sequence = 0;        // Analysis frame counter, 0 before the first frame
+  uint32_t captureMicros = 0;   // micros() when the frame's last sample was read
+};
+
+/**
+ * @brief Lock-free single-producer/single-consumer queue of analysis frames
+ *
+ * MicI2S pushes one result per completed Goertzel frame; a single
+ * consumer (typically one LedStrip) pops them from another task or core
+ * without locks. When the queue is full the new result is dropped and
+ * counted, so a stalled consumer never blocks the microphone.
+ *
+ * The consumer may register its FreeRTOS task to be notified on every
+ * push, so it can react to a new frame without waiting for its own
+ * polling interval.
+ */
+class MicResultChannel {
+ public:
+  static constexpr uint8_t kCapacity = 4;  // Power of two
+
+  MicResultChannel() : head_(0), tail_(0), consumerTask_(nullptr), dropped_(0) {}
+
+  MicResultChannel(const MicResultChannel&) = delete;
+  MicResultChannel& operator=(const MicResultChannel&) = delete;
+
+  /**
+   * @brief Queue a result (producer side)
+   * @return false if the queue was full and the result was dropped
+   */
+  bool push(const MicDetectionResult& result) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    slots_[head & (kCapacity - 1)] = result;
+    head_.store(head + 1, std::memory_order_release);
+    TaskHandle_t consumer = consumerTask_.load(std::memory_order_acquire);
+    if (consumer != nullptr) {
+      xTaskNotifyGive(consumer);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Take the oldest queued result (consumer side)
+   * @return false if the queue is empty
+   */
+  bool pop(MicDetectionResult& result) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    result = slots_[tail & (kCapacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Drain the queue and keep only the newest result (consumer side)
+   * @return false if the queue was empty
+   */
+  bool popLatest(MicDetectionResult& result) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    if (tail == head) {
+      return false;
+    }
+    result = slots_[(head - 1) & (kCapacity - 1)];
+    tail_.store(head, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Check for queued results (consumer side)
+   */
+  bool available() const {
+    return tail_.load(std::memory_order_relaxed) != head_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Task to notify with xTaskNotifyGive() on every push, nullptr for none
+   */
+  void setConsumerTask(TaskHandle_t task) { consumerTask_.store(task, std::memory_order_release); }
+
+  /**
+   * @brief Number of results dropped because the queue was full
+   */
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  MicDetectionResult slots_[kCapacity];
+  std::atomic<uint32_t> head_;             // Next slot to write, owned by the producer
+  std::atomic<uint32_t> tail_;             // Next slot to read, owned by the consumer
+  std::atomic<TaskHandle_t> consumerTask_;
+  std::atomic<uint32_t> dropped_;
+};
+
+/**
+ * @brief Latest-wins handoff of analysis frames from one task to another
+ *
+ * Triple buffered: the producer fills its own slot and swaps it into the
+ * mailbox, the consumer swaps the mailbox with the slot it last read.
+ * Neither side waits, and a consumer that stalls gets the newest frame
+ * when it comes back; the frames in between are overwritten, not queued.
+ * Use MicResultChannel to see every frame.
+ */
+class MicResultMailbox {
+ public:
+  MicResultMailbox() : back_(0), mail_(1), front_(2) {}
+
+  MicResultMailbox(const MicResultMailbox&) = delete;
+  MicResultMailbox& operator=(const MicResultMailbox&) = delete;
+
+  /**
+   * @brief Replace the unread result, if any (producer side)
+   */
+  void publish(const MicDetectionResult& result) {
+    slots_[back_] = result;
+    back_ = mail_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+  }
+
+  /**
+   * @brief Take the newest result published since the last take (consumer side)
+   * @return false if nothing new was published
+   */
+  bool take(MicDetectionResult& result) {
+    if ((mail_.load(std::memory_order_relaxed) & kFresh) == 0) {
+      return false;
+    }
+    front_ = mail_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    result = slots_[front_];
+    return true;
+  }
+
+ private:
+  static constexpr uint8_t kFresh = 0x80;
+  static constexpr uint8_t kIndexMask = 0x03;
+
+  MicDetectionResult slots_[3];
+  uint8_t back_;                // Slot the producer writes, owned by the producer
+  std::atomic<uint8_t> mail_;   // Slot handed over, kFresh while unread
+  uint8_t front_;               // Slot the consumer last read, owned by the consumer
+};
+
+}  // namespace espmods::audio
@@ -8,34 +8,33 @@ namespace espmods::audio {
 namespace {
 constexpr float kPi = 3.14159265358979323846f;
 constexpr float kTwoPi = 2.0f * kPi;
-constexpr float kI2sNormalization = 8388608.0f;  // 2^23 for 24-bit samples
+constexpr float kSampleScale = 1.0f / 8388608.0f;  // 2^-23 for 24-bit samples
 constexpr float kSampleRate = 16000.0f;
 constexpr bool kUseHannWindow = true;
-constexpr float kGoertzelFrequencies[] = {210.0f, 240.0f, 270.0f, 480.0f, 120.0f, 390.0f};
-constexpr size_t kGoertzelBinCount = sizeof(kGoertzelFrequencies) / sizeof(kGoertzelFrequencies[0]);
+// Toothbrush motor: 210-270 Hz fundamentals and the 480 Hz harmonic over
+// the 120 and 390 Hz background
+constexpr MicBin kToothbrushBins[] = {
+    {210.0f, 1.0f, 0.0f, true}, {240.0f, 1.0f, 0.0f, true}, {270.0f, 1.0f, 0.0f, true},
+    {480.0f, 0.5f, 0.0f, false}, {120.0f, 0.0f, 1.0f, false}, {390.0f, 0.0f, 1.0f, false},
+};
 constexpr float kRatioEmaAlpha = 0.2f;
 constexpr float kTonalityEmaAlpha = 0.2f;
 constexpr float kDetectionEpsilon = 1e-6f;
+}  // namespace
 
-struct GoertzelState {
-  float coeff;
-  float s1;
-  float s2;
-};
+MicI2S::MicI2S(gpio_num_t bclk, gpio_num_t lrclk, gpio_num_t data)
+    : bclk_(bclk), lrclk_(lrclk), data_(data) {
+  setBins(kToothbrushBins, sizeof(kToothbrushBins) / sizeof(kToothbrushBins[0]));
+}
 
-float hannWindow(size_t index, size_t total) {
-  if (!kUseHannWindow || total <= 1) {
-    return 1.0f;
+MicI2S::~MicI2S() {
+  if (captureTask_ != nullptr) {
+    vTaskDelete(captureTask_);
   }
-  const float phase = static_cast<float>(index) / static_cast<float>(total - 1);
-  return 0.5f * (1.0f - cosf(kTwoPi * phase));
 }
-}  // namespace
-
-MicI2S::MicI2S(gpio_num_t bclk, gpio_num_t lrclk, gpio_num_t data)
-    : bclk_(bclk), lrclk_(lrclk), data_(data) {}
 
 void MicI2S::begin() {
+  buildTables();
   i2s_config_t i2s_config = {
       .mode = static_cast<i2s_mode_t>(I2S_MODE_MASTER | I2S_MODE_RX),
       .sample_rate = static_cast<int>(kSampleRate),
@@ -60,65 +59,200 @@ void MicI2S::begin() {
   i2s_set_clk(I2S_NUM_1, static_cast<uint32_t>(kSampleRate), I2S_BITS_PER_SAMPLE_32BIT, I2S_CHANNEL_STEREO);
 }
 
-float MicI2S::sampleRms() { return rms_; }
+void MicI2S::buildTables() {
+  // The window is fixed per frame length, so the per-frame loop only reads
+  // it. It is stored in the bank's interleaved sample order, like
+  // frameBuffer_; bin coefficients are set with the bins. Scaling by a
+  // power of two is exact, so raw * table equals (raw / 2^23) * window.
+  for (size_t n = 0; n < kSampleCount; ++n) {
+    const float phase = static_cast<float>(n) / static_cast<float>(kSampleCount - 1);
+    const float window = kUseHannWindow ? 0.5f * (1.0f - cosf(kTwoPi * phase)) : 1.0f;
+    hannTable_[GoertzelBank::interleavedIndex(n, kSampleCount)] = window * kSampleScale;
+  }
+}
 
-float MicI2S::sampleWindowedRms() { return windowedRms_; }
+bool MicI2S::setBins(const MicBin *bins, size_t count) {
+  // The capture task reads the bins and bank on every frame
+  if (captureTask_ != nullptr || bins == nullptr || count == 0 || count > kMaxBins) {
+    return false;
+  }
+  float frequencies[kMaxBins];
+  for (size_t i = 0; i < count; ++i) {
+    if (!(bins[i].frequency > 0.0f && bins[i].frequency < 0.5f * kSampleRate)) {
+      return false;
+    }
+    frequencies[i] = bins[i].frequency;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    bins_[i] = bins[i];
+  }
+  binCount_ = count;
+  goertzel_.setFrequencies(frequencies, count, kSampleRate);
 
-void MicI2S::accumulateWindowSample(float sample) {
-  if (windowFill_ < kWindowSize) {
-    ++windowFill_;
-  } else {
-    float oldSample = window_[windowIndex_];
-    windowSum_ -= oldSample;
-    windowSumSquares_ -= static_cast<double>(oldSample) * oldSample;
-  }
-  window_[windowIndex_] = sample;
-  windowSum_ += sample;
-  windowSumSquares_ += static_cast<double>(sample) * sample;
-  windowIndex_ = (windowIndex_ + 1) % kWindowSize;
+  // Ratio and tonality of a different bin set are on a different scale
+  ratioInitialized_ = false;
+  tonalityInitialized_ = false;
+  onStreak_ = 0;
+  offStreak_ = 0;
+  active_ = false;
+  detection_ = MicDetectionResult();
+  detection_.binCount = static_cast<uint8_t>(count);
+  return true;
+}
+
+bool MicI2S::startCaptureTask(int8_t core, uint8_t priority) {
+  if (captureTask_ != nullptr) {
+    return true;
+  }
+  if (core < 0) {
+    // Default to the core the caller (usually the Arduino loop) is not on
+    core = xPortGetCoreID() == 0 ? 1 : 0;
+  }
+  // Set before the task exists, so the task sees it from its first frame
+  taskCapture_ = true;
+  BaseType_t created = xTaskCreatePinnedToCore(captureTaskEntry, "MicI2S", kCaptureTaskStackSize, this,
+                                               priority, &captureTask_, core);
+  if (created != pdPASS) {
+    captureTask_ = nullptr;
+    taskCapture_ = false;
+    return false;
+  }
+  return true;
+}
+
+void MicI2S::captureTaskEntry(void *arg) {
+  MicI2S *self = static_cast<MicI2S *>(arg);
+  for (;;) {
+    float ratioOn = self->ratioOnOverride_.load(std::memory_order_relaxed);
+    float ratioHold = self->ratioHoldOverride_.load(std::memory_order_relaxed);
+    if (ratioOn > 0.0f) {
+      self->params_.ratioOn = ratioOn;
+    }
+    if (ratioHold > 0.0f) {
+      self->params_.ratioHold = ratioHold;
+    }
+    // Sleeps in i2s_read() until the DMA completes the next buffer, so the
+    // frame is analysed as soon as its last sample lands
+    bool haveFrame = self->fillFrame(portMAX_DELAY);
+    self->analyseFrame(haveFrame, millis());
+    if (!haveFrame) {
+      vTaskDelay(1);  // Driver error; do not spin
+    }
+  }
+}
+
+float MicI2S::sampleRms() { return rms_.load(std::memory_order_relaxed); }
+
+float MicI2S::sampleWindowedRms() { return windowedRms_.load(std::memory_order_relaxed); }
+
+void MicI2S::accumulateWindow(const int32_t *samples, size_t count) {
+  // Slots not yet filled hold zero, so the ring is updated the same way
+  // before and after it is full
+  while (count > 0) {
+    size_t run = kWindowSize - windowIndex_;
+    if (run > count) {
+      run = count;
+    }
+    int32_t *slot = window_ + windowIndex_;
+    int64_t sum = 0;
+    int64_t sumSquares = 0;
+    for (size_t i = 0; i < run; ++i) {
+      int32_t oldSample = slot[i];
+      int32_t sample = samples[i];
+      slot[i] = sample;
+      sum += sample - oldSample;
+      sumSquares += static_cast<int64_t>(sample) * sample - static_cast<int64_t>(oldSample) * oldSample;
+    }
+    windowSum_ += sum;
+    windowSumSquares_ += sumSquares;
+    windowFill_ = windowFill_ + run < kWindowSize ? windowFill_ + run : kWindowSize;
+    windowIndex_ = (windowIndex_ + run) % kWindowSize;
+    samples += run;
+    count -= run;
+  }
 }
 
 void MicI2S::updateWindowedMetrics() {
   if (windowFill_ == 0) {
     return;
   }
-  double count = static_cast<double>(windowFill_);
-  double mean = windowSum_ / count;
-  double meanSquares = windowSumSquares_ / count;
-  double variance = meanSquares - (mean * mean);
-  if (variance < 0.0) {
-    variance = 0.0;
+  // Sum of squares about the truncated integer mean, exact in 64 bits;
+  // the remainder's share is below one LSB squared per sample
+  const int64_t count = static_cast<int64_t>(windowFill_);
+  const int64_t mean = windowSum_ / count;
+  const int64_t remainder = windowSum_ - mean * count;
+  const int64_t centred = windowSumSquares_ - 2 * mean * windowSum_ + mean * mean * count;
+  float variance = (static_cast<float>(centred) - static_cast<float>(remainder * remainder) / count) / count;
+  if (variance < 0.0f) {
+    variance = 0.0f;
   }
-  float rawRms = sqrtf(static_cast<float>(variance));
+  float rawRms = sqrtf(variance) * kSampleScale;
+  float windowedRms = rawRms;
   if (!windowInitialized_) {
-    windowedRms_ = rawRms;
     windowInitialized_ = true;
   } else {
-    windowedRms_ = windowedRms_ * (1.0f - kWindowEmaAlpha) + rawRms * kWindowEmaAlpha;
+    float previous = windowedRms_.load(std::memory_order_relaxed);
+    windowedRms = previous * (1.0f - kWindowEmaAlpha) + rawRms * kWindowEmaAlpha;
   }
-  if (windowedRms_ > 0.0f) {
-    float dbfs = 20.0f * log10f(windowedRms_);
-    windowedDbfs_ = dbfs > kDbfsFloor ? dbfs : kDbfsFloor;
-  } else {
-    windowedDbfs_ = kDbfsFloor;
+  windowedRms_.store(windowedRms, std::memory_order_relaxed);
+  float dbfs = kDbfsFloor;
+  if (windowedRms > 0.0f) {
+    dbfs = 20.0f * log10f(windowedRms);
+    if (dbfs < kDbfsFloor) {
+      dbfs = kDbfsFloor;
+    }
   }
+  windowedDbfs_.store(dbfs, std::memory_order_relaxed);
 }
 
-void MicI2S::setDetectionParams(const MicDetectionParams &params) {
+bool MicI2S::setDetectionParams(const MicDetectionParams &params) {
+  if (captureTask_ != nullptr) {
+    return false;
+  }
   params_ = params;
   if (params_.debounceFrames == 0) {
     params_.debounceFrames = 1;
   }
+  return true;
+}
+
+bool MicI2S::setResultChannel(MicResultChannel *channel) {
+  if (captureTask_ != nullptr) {
+    return false;
+  }
+  channel_ = channel;
+  return true;
 }
 
-void MicI2S::muteUntil(uint32_t millisUntil) { mutedUntil_ = millisUntil; }
+void MicI2S::muteUntil(uint32_t millisUntil) { mutedUntil_.store(millisUntil, std::memory_order_relaxed); }
 
-bool MicI2S::fillFrame() {
+void MicI2S::convertBlock(int32_t *words, size_t count) {
+  // Q31 words to 24-bit samples in place, then windowed floats in frame
+  // order; the squares for the frame RMS stay integer
+  int64_t sumSquares = 0;
+  for (size_t i = 0; i < count; ++i) {
+    int32_t sample = words[i] >> 8;  // 24-bit left justified
+    words[i] = sample;
+    sumSquares += static_cast<int64_t>(sample) * sample;
+    size_t index = GoertzelBank::interleavedIndex(frameFill_ + i, kSampleCount);
+    frameBuffer_[index] = static_cast<float>(sample) * hannTable_[index];
+  }
+  frameFill_ += count;
+  frameSumSquares_ += sumSquares;
+  accumulateWindow(words, count);
+}
+
+bool MicI2S::fillFrame(TickType_t ticksToWait) {
   bool receivedSamples = false;
   while (frameFill_ < kSampleCount) {
-    int32_t buffer[64];
+    // Never read past the frame, so every word read is used
+    int32_t buffer[kReadBlock];
+    size_t wanted = kSampleCount - frameFill_;
+    if (wanted > kReadBlock) {
+      wanted = kReadBlock;
+    }
     size_t bytesRead = 0;
-    esp_err_t err = i2s_read(I2S_NUM_1, buffer, sizeof(buffer), &bytesRead, 0);
+    esp_err_t err = i2s_read(I2S_NUM_1, buffer, wanted * sizeof(int32_t), &bytesRead, ticksToWait);
     if (err != ESP_OK || bytesRead == 0) {
       break;
     }
@@ -127,13 +261,9 @@ bool MicI2S::fillFrame() {
       break;
     }
     receivedSamples = true;
-    for (size_t i = 0; i < samples && frameFill_ < kSampleCount; ++i) {
-      int32_t raw24 = buffer[i] >> 8;  // 24-bit left justified
-      float sample = static_cast<float>(raw24) / kI2sNormalization;
-      frameBuffer_[frameFill_++] = sample;
-      accumulateWindowSample(sample);
-    }
+    convertBlock(buffer, samples);
     if (frameFill_ >= kSampleCount) {
+      frameMicros_ = micros();
       break;
     }
   }
@@ -144,48 +274,26 @@ bool MicI2S::fillFrame() {
 }
 
 void MicI2S::runGoertzel() {
-  GoertzelState states[kGoertzelBinCount];
-  for (size_t i = 0; i < kGoertzelBinCount; ++i) {
-    const float omega = kTwoPi * kGoertzelFrequencies[i] / kSampleRate;
-    states[i].coeff = 2.0f * cosf(omega);
-    states[i].s1 = 0.0f;
-    states[i].s2 = 0.0f;
-  }
-
-  double sumSquares = 0.0;
-  for (size_t n = 0; n < kSampleCount; ++n) {
-    float sample = frameBuffer_[n];
-    sumSquares += static_cast<double>(sample) * sample;
-    float window = hannWindow(n, kSampleCount);
-    float windowedSample = sample * window;
-    for (auto &state : states) {
-      float s = windowedSample + state.coeff * state.s1 - state.s2;
-      state.s2 = state.s1;
-      state.s1 = s;
-    }
-  }
-
-  for (size_t i = 0; i < kGoertzelBinCount; ++i) {
-    const auto &state = states[i];
-    float power = state.s1 * state.s1 + state.s2 * state.s2 - state.coeff * state.s1 * state.s2;
-    if (power < 0.0f) {
-      power = 0.0f;
-    }
+  goertzel_.process(frameBuffer_, kSampleCount);
+  float numerator = 0.0f;
+  float denominator = 0.0f;
+  float tonalSum = 0.0f;
+  float maxTonal = 0.0f;
+  for (size_t i = 0; i < binCount_; ++i) {
+    const MicBin &bin = bins_[i];
+    float power = goertzel_.power(i);
     detection_.bins[i] = power;
+    numerator += bin.numeratorWeight * power;
+    denominator += bin.denominatorWeight * power;
+    if (bin.tonal) {
+      tonalSum += power;
+      if (power > maxTonal) {
+        maxTonal = power;
+      }
+    }
   }
-
-  float harmonicSum = detection_.bins[0] + detection_.bins[1] + detection_.bins[2];
-  float maxHarmonic = detection_.bins[0];
-  if (detection_.bins[1] > maxHarmonic) {
-    maxHarmonic = detection_.bins[1];
-  }
-  if (detection_.bins[2] > maxHarmonic) {
-    maxHarmonic = detection_.bins[2];
-  }
-  float numerator = harmonicSum + 0.5f * detection_.bins[3];
-  float denominator = detection_.bins[4] + detection_.bins[5] + kDetectionEpsilon;
-  float ratio = numerator / denominator;
-  float tonality = maxHarmonic / (harmonicSum + kDetectionEpsilon);
+  float ratio = numerator / (denominator + kDetectionEpsilon);
+  float tonality = maxTonal / (tonalSum + kDetectionEpsilon);
 
   if (!ratioInitialized_) {
     ratioEma_ = ratio;
@@ -204,12 +312,39 @@ void MicI2S::runGoertzel() {
   detection_.ratioEma = ratioEma_;
   detection_.tonality = tonality;
   detection_.tonalityEma = tonalityEma_;
-  detection_.rms = sqrtf(static_cast<float>(sumSquares / static_cast<double>(kSampleCount)));
+  detection_.rms = sqrtf(static_cast<float>(frameSumSquares_) / kSampleCount) * kSampleScale;
+  frameSumSquares_ = 0;
   detection_.frameValid = true;
-  rms_ = detection_.rms;
+  detection_.sequence = ++frameSequence_;
+  detection_.captureMicros = frameMicros_;
+  rms_.store(detection_.rms, std::memory_order_relaxed);
+}
+
+void MicI2S::publishFrame() {
+  if (channel_ != nullptr) {
+    channel_->push(detection_);
+  }
+  if (taskCapture_) {
+    taskResults_.publish(detection_);
+  }
 }
 
 MicDetectionResult MicI2S::update(float ratioOnThreshold, float ratioHoldThreshold) {
+  if (captureTask_ != nullptr) {
+    if (ratioOnThreshold > 0.0f) {
+      ratioOnOverride_.store(ratioOnThreshold, std::memory_order_relaxed);
+    }
+    if (ratioHoldThreshold > 0.0f) {
+      ratioHoldOverride_.store(ratioHoldThreshold, std::memory_order_relaxed);
+    }
+    // Only the newest frame matters to the caller; older ones were
+    // published to the result channel as they completed
+    if (!taskResults_.take(latest_)) {
+      latest_.frameValid = false;
+    }
+    return latest_;
+  }
+
   if (ratioOnThreshold > 0.0f) {
     params_.ratioOn = ratioOnThreshold;
   }
@@ -218,7 +353,11 @@ MicDetectionResult MicI2S::update(float ratioOnThreshold, float ratioHoldThresho
   }
 
   uint32_t now = millis();
-  bool haveFrame = fillFrame();
+  analyseFrame(fillFrame(0), now);
+  return detection_;
+}
+
+void MicI2S::analyseFrame(bool haveFrame, uint32_t now) {
   if (haveFrame) {
     runGoertzel();
     frameFill_ = 0;
@@ -226,12 +365,15 @@ MicDetectionResult MicI2S::update(float ratioOnThreshold, float ratioHoldThresho
     detection_.frameValid = false;
   }
 
-  if (now < mutedUntil_) {
+  if (now < mutedUntil_.load(std::memory_order_relaxed)) {
     active_ = false;
     onStreak_ = 0;
     offStreak_ = 0;
     detection_.brushing = false;
-    return detection_;
+    if (haveFrame) {
+      publishFrame();
+    }
+    return;
   }
 
   if (haveFrame) {
@@ -279,13 +421,15 @@ MicDetectionResult MicI2S::update(float ratioOnThreshold, float ratioHoldThresho
   }
 
   detection_.brushing = active_;
-  return detection_;
+  if (haveFrame) {
+    publishFrame();
+  }
 }
 
 bool MicI2S::brushingActive() const {
-  if (millis() < mutedUntil_) {
+  if (millis() < mutedUntil_.load(std::memory_order_relaxed)) {
     return false;
   }
-  return active_;
+  return captureTask_ != nullptr ? latest_.brushing : active_;
 }
 }
\ No newline at end of file
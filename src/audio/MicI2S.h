@@ -3,6 +3,11 @@
 #include <Arduino.h>
 #include <driver/i2s.h>
 
+#include <atomic>
+
+#include "GoertzelBank.h"
+#include "MicDetection.h"
+
 namespace espmods::audio {
 
 struct MicDetectionParams {
@@ -13,31 +18,44 @@ struct MicDetectionParams {
   uint8_t debounceFrames = 5;   // Number of consecutive frames for state flips
 };
 
-struct MicDetectionResult {
-  bool brushing = false;        // Current brushing state after debounce
-  bool frameValid = false;      // True when the most recent Goertzel frame ran
-  float rms = 0.0f;             // RMS of the latest frame
-  float ratio = 0.0f;           // Instantaneous spectral ratio for this frame
-  float ratioEma = 0.0f;        // Smoothed spectral ratio (EMA)
-  float tonality = 0.0f;        // Instantaneous tonality for this frame
-  float tonalityEma = 0.0f;     // Smoothed tonality (EMA)
-  float bins[6] = {0.0f};       // Bin order: 210, 240, 270, 480, 120, 390 Hz
-};
-
 class MicI2S {
  public:
   MicI2S(gpio_num_t bclk, gpio_num_t lrclk, gpio_num_t data);
+  ~MicI2S();
   void begin();
+  // Capture and analyse on a FreeRTOS task that blocks until the I2S DMA
+  // fills a buffer, instead of polling from update(); the DMA ring then
+  // holds 256 ms of audio however long loop() stalls. update() returns the
+  // newest frame the task published; frames loop() misses are overwritten,
+  // so a stalled loop() catches up at once. Call after begin(): while the
+  // task runs, setDetectionParams(), setBins() and setResultChannel()
+  // return false and change nothing. core -1 picks the core the caller is
+  // not on
+  bool startCaptureTask(int8_t core = -1, uint8_t priority = 3);
+  bool isCaptureTaskRunning() const { return captureTask_ != nullptr; }
   float sampleRms();
   float sampleWindowedRms();
-  float windowedRms() const { return windowedRms_; }
-  float windowedDbfs() const { return windowedDbfs_; }
+  float windowedRms() const { return windowedRms_.load(std::memory_order_relaxed); }
+  float windowedDbfs() const { return windowedDbfs_.load(std::memory_order_relaxed); }
   MicDetectionResult update(float ratioOnThreshold, float ratioHoldThreshold);
   bool brushingActive() const;
   void muteUntil(uint32_t millisUntil);
-  const MicDetectionResult &lastDetection() const { return detection_; }
-  void setDetectionParams(const MicDetectionParams &params);
+  const MicDetectionResult &lastDetection() const { return captureTask_ != nullptr ? latest_ : detection_; }
+  // false while the capture task runs; pass thresholds to update() instead
+  bool setDetectionParams(const MicDetectionParams &params);
   const MicDetectionParams &detectionParams() const { return params_; }
+  // Replace the detection bins (the toothbrush set by default); resets the
+  // smoothed ratio, tonality and brushing state. false if count is 0, above
+  // kMaxBins, a frequency is outside (0, sample rate / 2) or the capture
+  // task runs
+  bool setBins(const MicBin *bins, size_t count);
+  const MicBin *bins() const { return bins_; }
+  size_t binCount() const { return binCount_; }
+  static constexpr size_t kMaxBins = GoertzelBank::kMaxBins;
+  // Publish every completed analysis frame to channel (nullptr to stop);
+  // the channel must outlive the microphone or be detached first. false
+  // while the capture task runs
+  bool setResultChannel(MicResultChannel *channel);
 
  private:
   gpio_num_t bclk_;
@@ -45,19 +63,24 @@ class MicI2S {
   gpio_num_t data_;
   static constexpr size_t kSampleCount = 512;
   static constexpr size_t kWindowSize = 1024;
+  static constexpr size_t kReadBlock = 128;  // Words per i2s_read()
+  static constexpr uint32_t kCaptureTaskStackSize = 4096;
   static constexpr float kWindowEmaAlpha = 0.2f;
   static constexpr float kDbfsFloor = -120.0f;
-  float rms_ = 0.0f;
-  float window_[kWindowSize] = {};
+  // Written by whichever context analyses, read from loop()
+  std::atomic<float> rms_{0.0f};
+  // 24-bit samples and exact integer sums, so nothing drifts however long
+  // the window runs; |sample| < 2^23 keeps the squares below 2^56
+  int32_t window_[kWindowSize] = {};
   size_t windowIndex_ = 0;
   size_t windowFill_ = 0;
-  double windowSum_ = 0.0;
-  double windowSumSquares_ = 0.0;
-  float windowedRms_ = 0.0f;
-  float windowedDbfs_ = kDbfsFloor;
+  int64_t windowSum_ = 0;
+  int64_t windowSumSquares_ = 0;
+  std::atomic<float> windowedRms_{0.0f};
+  std::atomic<float> windowedDbfs_{kDbfsFloor};
   bool windowInitialized_ = false;
   bool active_ = false;
-  uint32_t mutedUntil_ = 0;
+  std::atomic<uint32_t> mutedUntil_{0};
   MicDetectionParams params_;
   MicDetectionResult detection_;
   bool ratioInitialized_ = false;
@@ -66,11 +89,36 @@ class MicI2S {
   float tonalityEma_ = 0.0f;
   uint8_t onStreak_ = 0;
   uint8_t offStreak_ = 0;
+  // Windowed samples in GoertzelBank::interleavedIndex() order
   float frameBuffer_[kSampleCount] = {};
+  int64_t frameSumSquares_ = 0;
+  // Built by begin(); plain members so they sit in DRAM with the object
+  // rather than in flash behind the cache. The window includes the 2^-23
+  // sample scale, so one multiply converts and windows a sample.
+  float hannTable_[kSampleCount] = {};
+  GoertzelBank goertzel_;
+  MicBin bins_[kMaxBins] = {};
+  size_t binCount_ = 0;
   size_t frameFill_ = 0;
-  void accumulateWindowSample(float sample);
+  uint32_t frameMicros_ = 0;
+  uint32_t frameSequence_ = 0;
+  MicResultChannel *channel_ = nullptr;
+  // Capture task: frames reach update() through taskResults_; the
+  // thresholds update() is given reach the task through the overrides
+  TaskHandle_t captureTask_ = nullptr;
+  bool taskCapture_ = false;
+  MicResultMailbox taskResults_;
+  MicDetectionResult latest_;
+  std::atomic<float> ratioOnOverride_{0.0f};
+  std::atomic<float> ratioHoldOverride_{0.0f};
+  static void captureTaskEntry(void *arg);
+  void analyseFrame(bool haveFrame, uint32_t now);
+  void buildTables();
+  void convertBlock(int32_t *words, size_t count);
+  void accumulateWindow(const int32_t *samples, size_t count);
   void updateWindowedMetrics();
-  bool fillFrame();
+  bool fillFrame(TickType_t ticksToWait);
   void runGoertzel();
+  void publishFrame();
 };
 }
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "LedOutput.h"
+#include "LedStrip.h"
+
+namespace espmods::led {
+
+namespace detail {
+
+// Storage for FixedLedStrip; a base class so it is constructed before LedStrip
+template <uint16_t kCount, typename T_COLOR_FEATURE, typename T_METHOD>
+struct FixedLedStripStorage {
+  explicit FixedLedStripStorage(uint8_t pin) : output(kCount, pin) {}
+
+  NeoPixelOutput<T_COLOR_FEATURE, T_METHOD> output;
+  LedColor frames[2 * kCount];
+  LedColor scratch[2 * kCount];
+};
+
+}  // namespace detail
+
+/**
+ * @brief LedStrip with the length, colour order and output method fixed at compile time
+ *
+ * Frame and transition buffers are part of the object, so a global
+ * FixedLedStrip lives in static memory and never touches the heap for
+ * its frames; only effects with per-pixel state allocate a block on
+ * first use. The NeoPixelBus feature and method are template arguments,
+ * e.g. FixedLedStrip<144, NeoGrbwFeature, NeoEsp32Rmt0Ws2812xMethod>.
+ *
+ * Buffer cost is 24 bytes per pixel (front, back and two transition
+ * buffers of 16-bit working colour), plus what the NeoPixelBus method
+ * itself allocates.
+ */
+template <uint16_t kCount, typename T_COLOR_FEATURE = NeoGrbFeature,
+          typename T_METHOD = NeoEsp32I2s0800KbpsMethod>
+class FixedLedStrip : private detail::FixedLedStripStorage<kCount, T_COLOR_FEATURE, T_METHOD>,
+                      public LedStrip {
+  static_assert(kCount > 0, "FixedLedStrip needs at least one pixel");
+  using Storage = detail::FixedLedStripStorage<kCount, T_COLOR_FEATURE, T_METHOD>;
+
+ public:
+  static constexpr uint16_t kLength = kCount;
+
+  /**
+   * @brief Constructor for a fixed-length LED strip
+   * @param pin GPIO pin connected to the LED strip data line
+   * @param brightness Default brightness (0-255)
+   */
+  explicit FixedLedStrip(uint8_t pin, uint8_t brightness = 128)
+      : Storage(pin), LedStrip(Storage::output, kCount, brightness, Storage::frames, Storage::scratch) {}
+};
+
+}  // namespace espmods::led
@@ -0,0 +1,136 @@
+#include "LedController.h"
+
+namespace espmods::led {
+
+LedController::LedController()
+    : strips_{},
+      stripCount_(0),
+      renderTask_(nullptr),
+      frameIntervalMs_(1000 / kDefaultTargetFps),
+      lastFrameTime_(0),
+      renderMicros_(0),
+      showMicros_(0) {}
+
+LedController::~LedController() {
+  for (uint8_t i = 0; i < stripCount_ && renderTask_ != nullptr; i++) {
+    strips_[i]->wakeTask_.store(nullptr, std::memory_order_release);
+    if (strips_[i]->audioChannel_ != nullptr) {
+      strips_[i]->audioChannel_->setConsumerTask(nullptr);
+    }
+  }
+  if (renderTask_ != nullptr) {
+    vTaskDelete(renderTask_);
+  }
+  for (uint8_t i = 0; i < stripCount_; i++) {
+    strips_[i]->controlled_ = false;
+  }
+}
+
+bool LedController::addStrip(LedStrip& strip) {
+  if (stripCount_ >= kMaxStrips || strip.isRenderTaskRunning() || strip.controlled_) {
+    return false;
+  }
+  strip.controlled_ = true;
+  strips_[stripCount_++] = &strip;
+  return true;
+}
+
+void LedController::begin() {
+  for (uint8_t i = 0; i < stripCount_; i++) {
+    strips_[i]->begin();
+  }
+}
+
+void LedController::update() {
+  if (renderTask_ != nullptr) {
+    return;
+  }
+  uint32_t now = millis();
+  uint32_t interval = frameIntervalMs_.load(std::memory_order_relaxed);
+  if (interval > 0 && now - lastFrameTime_ < interval && !inputPending()) {
+    return;
+  }
+  lastFrameTime_ = now;
+  renderFrame(now);
+}
+
+bool LedController::startRenderTask(int8_t core, uint8_t priority) {
+  if (renderTask_ != nullptr) {
+    return true;
+  }
+  if (core < 0) {
+    // Default to the core the caller (usually the Arduino loop) is not on
+    core = xPortGetCoreID() == 0 ? 1 : 0;
+  }
+  BaseType_t created = xTaskCreatePinnedToCore(renderTaskEntry, "LedController", kRenderTaskStackSize,
+                                               this, priority, &renderTask_, core);
+  if (created != pdPASS) {
+    renderTask_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void LedController::renderTaskEntry(void* arg) {
+  LedController* self = static_cast<LedController*>(arg);
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  for (uint8_t i = 0; i < self->stripCount_; i++) {
+    self->strips_[i]->wakeTask_.store(task, std::memory_order_release);
+    if (self->strips_[i]->audioChannel_ != nullptr) {
+      self->strips_[i]->audioChannel_->setConsumerTask(task);
+    }
+  }
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    self->renderFrame(millis());
+    TickType_t ticks = pdMS_TO_TICKS(self->frameIntervalMs_.load(std::memory_order_relaxed));
+    if (ticks == 0) {
+      ticks = 1;
+    }
+    // Sleep until the next frame slot or new mic or stream input, whichever is first
+    TickType_t elapsed = xTaskGetTickCount() - lastWake;
+    ulTaskNotifyTake(pdTRUE, elapsed < ticks ? ticks - elapsed : 0);
+    lastWake = xTaskGetTickCount();
+  }
+}
+
+void LedController::setTargetFps(uint8_t fps) {
+  frameIntervalMs_.store(fps > 0 ? 1000 / fps : 0, std::memory_order_relaxed);
+}
+
+bool LedController::inputPending() const {
+  for (uint8_t i = 0; i < stripCount_; i++) {
+    if (strips_[i]->inputPending()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void LedController::renderFrame(uint32_t now) {
+  // Render everything before the first Show() so the transfers start together
+  uint32_t renderStart = micros();
+  bool changed = false;
+  for (uint8_t i = 0; i < stripCount_; i++) {
+    changed |= strips_[i]->composeFrame(now);
+  }
+  renderMicros_ = micros() - renderStart;
+
+  if (!changed) {
+    for (uint8_t i = 0; i < stripCount_; i++) {
+      strips_[i]->framesSkipped_++;
+    }
+    return;
+  }
+
+  // Unchanged strips are shown too: parallel I2S buses only transmit once
+  // every strip on them has called Show(), and their buffers still hold
+  // the previous frame
+  uint32_t showStart = micros();
+  for (uint8_t i = 0; i < stripCount_; i++) {
+    strips_[i]->pushFrame();
+  }
+  showMicros_ = micros() - showStart;
+}
+
+}  // namespace espmods::led
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#include "LedStrip.h"
+
+namespace espmods::led {
+
+/**
+ * @brief Drives several strips on separate outputs from one frame loop
+ *
+ * Each strip keeps its own effects, segments and output stage; the
+ * controller renders all of them first and then calls Show() on every
+ * strip back to back. With asynchronous outputs (RMT channels, the I2S
+ * parallel methods) the transfers then run at the same time, so a frame
+ * takes as long as the longest strip instead of the sum of all strips.
+ *
+ * Typical layout with MicI2S holding I2S1: up to eight strips on I2S0 in
+ * parallel mode (NeoEsp32I2s0X8Ws2812xMethod) plus further strips on RMT
+ * channels (NeoEsp32Rmt0Ws2812xMethod ...). The parallel methods only
+ * start a transfer once every strip sharing the peripheral has called
+ * Show(), so strips on them must be driven by a controller; it shows all
+ * strips whenever any of them changed.
+ *
+ * Strips with an audio source (LedStrip::setAudioSource()) or a stream
+ * (LedStrip::beginStream()) render as soon as a new mic or stream frame
+ * arrives, as they do on their own; set the audio source before
+ * startRenderTask().
+ */
+class LedController {
+ public:
+  static constexpr uint8_t kMaxStrips = 16;
+
+  LedController();
+  ~LedController();
+
+  /**
+   * @brief Add a strip to the frame loop
+   *
+   * The strip's own update() becomes a no-op. Call before begin().
+   * @param strip Strip to drive; must outlive the controller
+   * @return false if the controller is full or the strip has its own render task
+   */
+  bool addStrip(LedStrip& strip);
+
+  /**
+   * @brief Initialize all strips
+   */
+  void begin();
+
+  /**
+   * @brief Render and push a frame for all strips - call this in loop()
+   */
+  void update();
+
+  /**
+   * @brief Render frames on a dedicated FreeRTOS task
+   * @param core CPU core to pin the task to, -1 for the core not running the caller
+   * @param priority FreeRTOS task priority
+   * @return true if the task is running
+   */
+  bool startRenderTask(int8_t core = -1, uint8_t priority = 2);
+
+  /**
+   * @brief Limit how often update() renders a frame
+   * @param fps Frames per second, 0 renders on every update() call
+   */
+  void setTargetFps(uint8_t fps);
+
+  uint8_t getStripCount() const { return stripCount_; }
+
+  /**
+   * @brief Time spent rendering all strips in the last frame
+   */
+  uint32_t getRenderMicros() const { return renderMicros_; }
+
+  /**
+   * @brief Time spent in the Show() calls of the last pushed frame
+   *
+   * With asynchronous outputs this is close to the cost of queueing the
+   * transfers, not their duration on the wire.
+   */
+  uint32_t getShowMicros() const { return showMicros_; }
+
+ private:
+  static constexpr uint8_t kDefaultTargetFps = 60;
+  static constexpr uint32_t kRenderTaskStackSize = 4096;
+
+  static void renderTaskEntry(void* arg);
+  void renderFrame(uint32_t now);
+  bool inputPending() const;
+
+  LedStrip* strips_[kMaxStrips];
+  uint8_t stripCount_;
+  TaskHandle_t renderTask_;
+  std::atomic<uint32_t> frameIntervalMs_;
+  uint32_t lastFrameTime_;
+  uint32_t renderMicros_;
+  uint32_t showMicros_;
+};
+
+}  // namespace espmods::led
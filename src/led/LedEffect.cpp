@@ -0,0 +1,485 @@
+#include "LedEffect.h"
+#include "LedMath.h"
+
+namespace espmods::led {
+
+namespace {
+
+constexpr uint8_t kFireCooling = 55;     // Higher values give shorter flames
+constexpr uint8_t kFireSparkZone = 7;    // Pixels at the base where sparks ignite
+constexpr float kVuSpanMinDb = 20.0f;    // Meter range at intensity 0
+constexpr float kVuSpanMaxDb = 80.0f;    // Meter range at intensity 255
+constexpr uint16_t kVuPeakHoldMs = 500;
+constexpr float kBeatAverageAlpha = 0.05f;    // ~0.6 s energy average at 31 analysis frames/s
+constexpr float kBeatMinRms = 0.001f;         // -60 dBFS, quieter frames never trigger
+constexpr uint16_t kBeatMinIntervalMs = 200;  // At most 300 beats per minute
+
+size_t bytePerPixelStateSize(uint16_t length) {
+  return length;
+}
+
+void bakeGradient(RgbColor* gradient, uint16_t length, uint32_t color1, uint32_t color2) {
+  fillGradient(gradient, length, hexToRgb(color1), hexToRgb(color2));
+}
+
+// Off / SolidColor / Strobe: static or two-state frames
+
+bool renderOff(LedEffectContext& context, void*) {
+  // Static frame: only repaint after a configuration change
+  if (!context.dirty()) {
+    return false;
+  }
+  context.fill(RgbColor(0, 0, 0));
+  return true;
+}
+
+bool renderSolidColor(LedEffectContext& context, void*) {
+  if (!context.dirty()) {
+    return false;
+  }
+  context.fill(hexToRgb(context.config().primaryColor));
+  return true;
+}
+
+bool renderStrobe(LedEffectContext& context, void*) {
+  const LedEffectConfig& fx = context.config();
+  uint32_t cycle = context.elapsed() % fx.speed;
+  bool on = cycle < (fx.speed / 2);
+  if (!context.frameChanged(on)) {
+    return false;
+  }
+  context.fill(on ? hexToRgb(fx.primaryColor) : RgbColor(0, 0, 0));
+  return true;
+}
+
+// Pulse
+
+bool renderPulse(LedEffectContext& context, void*) {
+  const LedEffectConfig& fx = context.config();
+  uint8_t level = wave8(context.elapsed(), fx.speed);
+  if (!context.frameChanged(level)) {
+    return false;
+  }
+  context.fill(scaleColor16(hexToRgb(fx.primaryColor), level));
+  return true;
+}
+
+// GradientPulse: per-pixel gradient baked once per configuration
+
+size_t gradientPulseStateSize(uint16_t length) {
+  return length * sizeof(RgbColor);
+}
+
+void beginGradientPulse(LedEffectContext& context, void* state) {
+  const LedEffectConfig& fx = context.config();
+  bakeGradient(static_cast<RgbColor*>(state), context.length(), fx.primaryColor, fx.secondaryColor);
+}
+
+bool renderGradientPulse(LedEffectContext& context, void* state) {
+  uint8_t level = wave8(context.elapsed(), context.config().speed);
+  if (!context.frameChanged(level)) {
+    return false;
+  }
+  // Each pixel costs one gradient lookup and one scale
+  const RgbColor* gradient = static_cast<const RgbColor*>(state);
+  for (uint16_t i = 0; i < context.length(); i++) {
+    context.setPixel(i, scaleColor16(gradient[i], level));
+  }
+  return true;
+}
+
+// RandomFlicker
+
+bool renderRandomFlicker(LedEffectContext& context, void*) {
+  const LedEffectConfig& fx = context.config();
+  if (!context.stepDue(fx.speed)) {
+    return false;
+  }
+
+  RgbColor baseColor = hexToRgb(fx.primaryColor);
+  LedRandom& random = context.random();
+  for (uint16_t i = 0; i < context.length(); i++) {
+    // Random flicker intensity between 50% and 100%
+    uint8_t flicker = 128 + random.below(fx.intensity) / 2;
+    context.setPixel(i, scaleColor16(baseColor, flicker));
+  }
+  return true;
+}
+
+// ColorWave: one full sine period between the two colours as a palette
+
+size_t colorWaveStateSize(uint16_t) {
+  return 256 * sizeof(RgbColor);
+}
+
+void beginColorWave(LedEffectContext& context, void* state) {
+  RgbColor color1 = hexToRgb(context.config().primaryColor);
+  RgbColor color2 = hexToRgb(context.config().secondaryColor);
+  RgbColor* palette = static_cast<RgbColor*>(state);
+  for (uint16_t k = 0; k < 256; k++) {
+    palette[k] = blendColor(color1, color2, sin16To8(k << 8));
+  }
+}
+
+bool renderColorWave(LedEffectContext& context, void* state) {
+  // An empty segment has nothing to draw and no per-pixel step
+  if (context.length() == 0) {
+    return false;
+  }
+  uint16_t waveProgress = phase16(context.elapsed(), context.config().speed);
+  if (!context.frameChanged(waveProgress)) {
+    return false;
+  }
+
+  // Q0.16 phase per pixel; uint16_t wrap-around replaces fmod()
+  const RgbColor* palette = static_cast<const RgbColor*>(state);
+  uint16_t step = 65536UL / context.length();
+  uint16_t wavePhase = waveProgress;
+  for (uint16_t i = 0; i < context.length(); i++) {
+    context.setPixel(i, palette[wavePhase >> 8]);
+    wavePhase += step;
+  }
+  return true;
+}
+
+// Fire: heat-map simulation, pixel 0 is the base of the flame
+
+bool renderFire(LedEffectContext& context, void* state) {
+  const LedEffectConfig& fx = context.config();
+  // The cooling and spark ranges divide by the length
+  if (context.length() == 0 || !context.stepDue(fx.speed)) {
+    return false;
+  }
+
+  uint16_t length = context.length();
+  uint8_t* heat = static_cast<uint8_t*>(state);
+  LedRandom& random = context.random();
+
+  // Cool every cell a little; one random draw covers four cells
+  // Short segments cool hardest; clamp before narrowing for the shortest
+  uint16_t coolingRange = (kFireCooling * 10) / length + 2;
+  uint8_t maxCooling = coolingRange > 255 ? 255 : coolingRange;
+  uint32_t bits = 0;
+  for (uint16_t i = 0; i < length; i++) {
+    if ((i & 3) == 0) {
+      bits = random.next();
+    }
+    uint8_t cooling = scale8(bits & 0xFF, maxCooling);
+    bits >>= 8;
+    heat[i] = heat[i] > cooling ? heat[i] - cooling : 0;
+  }
+
+  // Heat rises away from the base and diffuses
+  for (uint16_t k = length - 1; k >= 2; k--) {
+    heat[k] = (heat[k - 1] + 2 * heat[k - 2]) / 3;
+  }
+
+  // Randomly ignite a new spark near the base
+  uint32_t r = random.next();
+  if ((r & 0xFF) < fx.intensity) {
+    uint16_t y = ((r >> 8) & 0xFF) % min<uint16_t>(length, kFireSparkZone);
+    uint16_t spark = heat[y] + 160 + ((r >> 16) & 0xFF) % 96;
+    heat[y] = spark > 255 ? 255 : spark;
+  }
+
+  for (uint16_t i = 0; i < length; i++) {
+    context.setPixel(i, heatColor(heat[i]));
+  }
+  return true;
+}
+
+// Lightning
+
+struct LightningState {
+  uint32_t startTime;
+  bool active;
+};
+
+size_t lightningStateSize(uint16_t) {
+  return sizeof(LightningState);
+}
+
+bool renderLightning(LedEffectContext& context, void* state) {
+  const LedEffectConfig& fx = context.config();
+  LightningState& lightning = *static_cast<LightningState*>(state);
+
+  // Lightning strikes every few seconds with random timing
+  if (!lightning.active && context.elapsed() > 1000 && context.random().below(100) < 2) {
+    lightning.active = true;
+    lightning.startTime = context.now();
+  }
+
+  // Stage 0 is dark; 1-3 are flash, brief darkness and the dimmer second flash
+  uint8_t stage = 0;
+  if (lightning.active) {
+    uint32_t lightningElapsed = context.now() - lightning.startTime;
+
+    if (lightningElapsed < 100) {
+      stage = 1;
+    } else if (lightningElapsed < 150) {
+      stage = 2;
+    } else if (lightningElapsed < 200) {
+      stage = 3;
+    } else {
+      // End lightning
+      lightning.active = false;
+      context.restart(); // Reset cycle
+    }
+  }
+  if (!context.frameChanged(stage)) {
+    return false;
+  }
+
+  RgbColor lightningColor(0, 0, 0);
+  if (stage == 1) {
+    // Bright flash
+    lightningColor = hexToRgb(fx.primaryColor);
+  } else if (stage == 3) {
+    // Second flash (dimmer)
+    lightningColor = hexToRgb(fx.primaryColor);
+    lightningColor.R /= 2;
+    lightningColor.G /= 2;
+    lightningColor.B /= 2;
+  }
+  context.fill(lightningColor);
+  return true;
+}
+
+// Rainbow
+
+bool renderRainbow(LedEffectContext& context, void*) {
+  if (context.length() == 0) {
+    return false;
+  }
+  uint16_t hue = phase16(context.elapsed(), context.config().speed);
+  if (!context.frameChanged(hue)) {
+    return false;
+  }
+  const RgbColor* wheel = hueWheel();
+  uint16_t step = 65536UL / context.length();
+
+  for (uint16_t i = 0; i < context.length(); i++) {
+    context.setPixel(i, wheel[hue >> 8]);
+    hue += step;
+  }
+  return true;
+}
+
+// Sparkle: per-pixel fade levels
+
+bool renderSparkle(LedEffectContext& context, void* state) {
+  const LedEffectConfig& fx = context.config();
+  // New sparkles index the empty state of an empty segment
+  if (context.length() == 0 || !context.stepDue(fx.speed)) {
+    return false;
+  }
+
+  RgbColor sparkleColor = hexToRgb(fx.primaryColor);
+  uint8_t* sparkles = static_cast<uint8_t*>(state);
+
+  // Fade existing sparkles
+  for (uint16_t i = 0; i < context.length(); i++) {
+    if (sparkles[i] > 0) {
+      sparkles[i] = max(0, sparkles[i] - 20);
+      context.setPixel(i, scaleColor16(sparkleColor, sparkles[i]));
+    } else {
+      context.setPixel(i, RgbColor(0, 0, 0));
+    }
+  }
+
+  // Add new sparkles
+  LedRandom& random = context.random();
+  uint8_t newSparkles = random.below(fx.intensity / 10 + 1);
+  for (uint8_t s = 0; s < newSparkles; s++) {
+    uint16_t pixel = random.below(context.length());
+    sparkles[pixel] = 255;
+  }
+  return true;
+}
+
+// VuMeter: bar following the mic level in dBFS, with a peak dot that
+// holds and then falls; pixel 0 is the bottom of the meter
+
+struct VuMeterState {
+  uint32_t level;     // Bar length in Q8 pixels
+  uint32_t peak;      // Peak position in Q8 pixels
+  uint32_t peakTime;  // When the peak was last raised
+  uint32_t lastTime;  // Previous render, for the fall rate
+};
+
+size_t vuMeterStateSize(uint16_t length) {
+  return sizeof(VuMeterState) + length * sizeof(RgbColor);
+}
+
+void beginVuMeter(LedEffectContext& context, void* state) {
+  const LedEffectConfig& fx = context.config();
+  VuMeterState& vu = *static_cast<VuMeterState*>(state);
+  vu.lastTime = context.now();
+  bakeGradient(reinterpret_cast<RgbColor*>(&vu + 1), context.length(), fx.primaryColor,
+               fx.secondaryColor);
+}
+
+uint32_t vuMeterTarget(const LedAudioFrame& audio, uint16_t length, uint8_t intensity) {
+  float rms = audio.result.rms;
+  if (!audio.valid || rms <= 0.0f) {
+    return 0;
+  }
+  // Higher intensity spans more dB, so quieter input still moves the bar
+  float span = kVuSpanMinDb + (kVuSpanMaxDb - kVuSpanMinDb) * intensity / 255.0f;
+  float fill = 1.0f + 20.0f * log10f(rms) / span;
+  if (fill <= 0.0f) {
+    return 0;
+  }
+  return static_cast<uint32_t>(min(fill, 1.0f) * length * 256.0f);
+}
+
+bool renderVuMeter(LedEffectContext& context, void* state) {
+  const LedEffectConfig& fx = context.config();
+  VuMeterState& vu = *static_cast<VuMeterState*>(state);
+  const RgbColor* gradient = reinterpret_cast<const RgbColor*>(&vu + 1);
+  uint16_t length = context.length();
+  uint32_t now = context.now();
+
+  // Instant attack; release drops the full bar length per speed ms
+  uint32_t full = static_cast<uint32_t>(length) << 8;
+  uint32_t elapsed = min<uint32_t>(now - vu.lastTime, fx.speed);
+  uint32_t fall = fx.speed > 0 ? elapsed * full / fx.speed : full;
+  vu.lastTime = now;
+
+  uint32_t target = vuMeterTarget(context.audio(), length, fx.intensity);
+  vu.level = target >= vu.level ? target : max(target, vu.level - min(fall, vu.level));
+  if (vu.level >= vu.peak) {
+    vu.peak = vu.level;
+    vu.peakTime = now;
+  } else if (now - vu.peakTime >= kVuPeakHoldMs) {
+    vu.peak = max(vu.level, vu.peak - min(fall, vu.peak));
+  }
+
+  uint16_t peakPixel = vu.peak > 0 ? (vu.peak - 1) >> 8 : length;
+  if (!context.frameChanged(vu.level | static_cast<uint32_t>(peakPixel) << 20)) {
+    return false;
+  }
+
+  // The top pixel of the bar is scaled by its fractional fill
+  uint16_t lit = vu.level >> 8;
+  uint8_t fraction = vu.level & 0xFF;
+  for (uint16_t i = 0; i < length; i++) {
+    if (i < lit) {
+      context.setPixel(i, gradient[i]);
+    } else if (i == lit && fraction > 0) {
+      context.setPixel(i, scaleColor16(gradient[i], fraction));
+    } else {
+      context.setPixel(i, RgbColor(0, 0, 0));
+    }
+  }
+  if (peakPixel < length) {
+    context.setPixel(peakPixel, hexToRgb(fx.secondaryColor));
+  }
+  return true;
+}
+
+// BeatPulse: flash on energy onsets, fading back to the secondary colour
+// over speed ms
+
+struct BeatPulseState {
+  float average;      // Slow average of frame energy
+  uint32_t beatTime;  // Last detected beat
+  bool primed;        // average holds at least one frame
+  bool beat;          // A beat has been detected since the effect started
+};
+
+size_t beatPulseStateSize(uint16_t) {
+  return sizeof(BeatPulseState);
+}
+
+bool renderBeatPulse(LedEffectContext& context, void* state) {
+  const LedEffectConfig& fx = context.config();
+  BeatPulseState& pulse = *static_cast<BeatPulseState*>(state);
+  const LedAudioFrame& audio = context.audio();
+  uint32_t now = context.now();
+
+  if (audio.fresh) {
+    float rms = audio.result.rms;
+    float energy = rms * rms;
+    if (!pulse.primed) {
+      pulse.average = energy;
+      pulse.primed = true;
+    }
+    // intensity 255 fires at 1.3x the average energy, 0 at 3x
+    float threshold = 3.0f - 1.7f * fx.intensity / 255.0f;
+    bool onset = rms > kBeatMinRms && energy > pulse.average * threshold;
+    if (onset && (!pulse.beat || now - pulse.beatTime >= kBeatMinIntervalMs)) {
+      pulse.beatTime = now;
+      pulse.beat = true;
+    }
+    pulse.average += (energy - pulse.average) * kBeatAverageAlpha;
+  }
+
+  uint8_t level = 0;
+  uint32_t sinceBeat = now - pulse.beatTime;
+  if (pulse.beat && sinceBeat < fx.speed) {
+    level = 255 - sinceBeat * 255 / fx.speed;
+  }
+  if (!context.frameChanged(level)) {
+    return false;
+  }
+  LedColor background = hexToRgb(fx.secondaryColor);
+  LedColor flash = hexToRgb(fx.primaryColor);
+  context.fill(blendColor(background, flash, level));
+  return true;
+}
+
+const LedEffectType kOffType = {"Off", nullptr, nullptr, renderOff};
+const LedEffectType kSolidColorType = {"SolidColor", nullptr, nullptr, renderSolidColor};
+const LedEffectType kPulseType = {"Pulse", nullptr, nullptr, renderPulse};
+const LedEffectType kGradientPulseType = {"GradientPulse", gradientPulseStateSize, beginGradientPulse,
+                                          renderGradientPulse};
+const LedEffectType kRandomFlickerType = {"RandomFlicker", nullptr, nullptr, renderRandomFlicker};
+const LedEffectType kStrobeType = {"Strobe", nullptr, nullptr, renderStrobe};
+const LedEffectType kColorWaveType = {"ColorWave", colorWaveStateSize, beginColorWave, renderColorWave};
+const LedEffectType kFireType = {"Fire", bytePerPixelStateSize, nullptr, renderFire};
+const LedEffectType kLightningType = {"Lightning", lightningStateSize, nullptr, renderLightning};
+const LedEffectType kRainbowType = {"Rainbow", nullptr, nullptr, renderRainbow};
+const LedEffectType kSparkleType = {"Sparkle", bytePerPixelStateSize, nullptr, renderSparkle};
+const LedEffectType kVuMeterType = {"VuMeter", vuMeterStateSize, beginVuMeter, renderVuMeter};
+const LedEffectType kBeatPulseType = {"BeatPulse", beatPulseStateSize, nullptr, renderBeatPulse};
+
+constexpr uint8_t kBuiltinEffects = static_cast<uint8_t>(LedEffect::BeatPulse) + 1;
+
+}  // namespace
+
+// Built-ins in LedEffect order, so their ids match the enum
+const LedEffectType* LedEffectRegistry::types_[kMaxEffects] = {
+    &kOffType,
+    &kSolidColorType,
+    &kPulseType,
+    &kGradientPulseType,
+    &kRandomFlickerType,
+    &kStrobeType,
+    &kColorWaveType,
+    &kFireType,
+    &kLightningType,
+    &kRainbowType,
+    &kSparkleType,
+    &kVuMeterType,
+    &kBeatPulseType,
+};
+
+std::atomic<uint8_t> LedEffectRegistry::count_(kBuiltinEffects);
+
+LedEffect LedEffectRegistry::add(const LedEffectType& type) {
+  uint8_t index = count_.load(std::memory_order_relaxed);
+  if (index >= kMaxEffects || type.render == nullptr) {
+    return LedEffect::Off;
+  }
+  types_[index] = &type;
+  count_.store(index + 1, std::memory_order_release);
+  return static_cast<LedEffect>(index);
+}
+
+const LedEffectType* LedEffectRegistry::find(LedEffect effect) {
+  uint8_t index = static_cast<uint8_t>(effect);
+  return index < count() ? types_[index] : nullptr;
+}
+
+}  // namespace espmods::led
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <Arduino.h>
+#include <NeoPixelBusLg.h>
+
+#include <atomic>
+
+#include "LedMath.h"
+#include "LedRandom.h"
+#include "audio/MicDetection.h"
+
+namespace espmods::led {
+
+/**
+ * @brief Effect identifier
+ *
+ * The named values are the built-in effects. Effects added with
+ * LedEffectRegistry::add() get the ids that follow.
+ */
+enum class LedEffect : uint8_t {
+  Off,
+  SolidColor,
+  Pulse,
+  GradientPulse,
+  RandomFlicker,
+  Strobe,
+  ColorWave,
+  Fire,
+  Lightning,
+  Rainbow,
+  Sparkle,
+  VuMeter,
+  BeatPulse
+};
+
+struct LedEffectConfig {
+  LedEffect effect = LedEffect::Off;
+  uint32_t primaryColor = 0xFF0000;    // Red default
+  uint32_t secondaryColor = 0x000000;  // Black default
+  uint32_t speed = 1000;               // Effect speed in milliseconds
+  uint8_t intensity = 255;             // Effect intensity (0-255)
+  bool reverse = false;                // Mirror the effect within its range
+};
+
+/**
+ * @brief A pixel range of the strip running its own effect
+ */
+struct LedSegment {
+  uint16_t start = 0;                  // First pixel of the segment
+  uint16_t length = 0;                 // Number of pixels in the segment
+  LedEffectConfig effect;              // Effect rendered into this range
+};
+
+/**
+ * @brief Timing state the strip keeps for each running effect
+ */
+struct LedEffectClock {
+  uint32_t startTime = 0;              // Effect start, moved by restart()
+  uint32_t lastStepTime = 0;           // Step timer for stepDue()
+  uint32_t frameKey = 0;               // Value the current frame was rendered from
+};
+
+/**
+ * @brief Microphone input as seen by effects
+ *
+ * Filled by the strip from its audio channel (LedStrip::setAudioSource())
+ * before each frame is rendered.
+ */
+struct LedAudioFrame {
+  audio::MicDetectionResult result;    // Newest analysis frame received
+  bool valid = false;                  // At least one frame has arrived
+  bool fresh = false;                  // result arrived since the previous render
+};
+
+/**
+ * @brief What an effect sees while rendering one segment
+ *
+ * Pixel indices are relative to the segment and already account for its
+ * direction. Colours are full scale; brightness and gamma are applied by
+ * the strip's output stage. Pixels are Q8.8 LedColor values: RgbColor
+ * widens implicitly, and scaleColor16()/blendColor() keep the fraction
+ * that 8-bit maths would drop.
+ */
+class LedEffectContext {
+ public:
+  LedEffectContext(const LedSegment& segment, LedEffectClock& clock, bool dirty, uint32_t now,
+                   LedRandom& random, const LedAudioFrame& audio, LedColor* frame)
+      : segment_(segment), clock_(clock), dirty_(dirty), now_(now), random_(random), audio_(audio),
+        frame_(frame) {}
+
+  const LedEffectConfig& config() const { return segment_.effect; }
+  uint16_t length() const { return segment_.length; }
+  uint32_t now() const { return now_; }
+  LedRandom& random() { return random_; }
+  const LedAudioFrame& audio() const { return audio_; }
+
+  /**
+   * @brief Milliseconds since the effect started (or last restart())
+   */
+  uint32_t elapsed() const { return now_ - clock_.startTime; }
+
+  /**
+   * @brief Restart elapsed() from the current frame
+   */
+  void restart() { clock_.startTime = now_; }
+
+  /**
+   * @brief True on the first frame after a configuration or layout change
+   *
+   * Static effects repaint only when this is set.
+   */
+  bool dirty() const { return dirty_; }
+
+  /**
+   * @brief Check whether the frame derived from key differs from the last one
+   *
+   * Effects that are a pure function of a small value (pulse level, wave
+   * phase) pass it here and skip rendering when it is unchanged.
+   */
+  bool frameChanged(uint32_t key) {
+    if (!dirty_ && key == clock_.frameKey) {
+      return false;
+    }
+    clock_.frameKey = key;
+    return true;
+  }
+
+  /**
+   * @brief Step timer for effects that advance at a fixed interval
+   * @return true (and restart the timer) if a step is due
+   */
+  bool stepDue(uint32_t interval) {
+    if (!dirty_ && now_ - clock_.lastStepTime < interval) {
+      return false;
+    }
+    clock_.lastStepTime = now_;
+    return true;
+  }
+
+  void setPixel(uint16_t index, const LedColor& color) {
+    frame_[segment_.effect.reverse ? segment_.start + segment_.length - 1 - index : segment_.start + index] = color;
+  }
+
+  void fill(const LedColor& color) {
+    // Direction does not matter for a uniform fill
+    LedColor* out = frame_ + segment_.start;
+    for (uint16_t i = 0; i < segment_.length; i++) {
+      out[i] = color;
+    }
+  }
+
+ private:
+  const LedSegment& segment_;
+  LedEffectClock& clock_;
+  bool dirty_;
+  uint32_t now_;
+  LedRandom& random_;
+  const LedAudioFrame& audio_;
+  LedColor* frame_;
+};
+
+/**
+ * @brief Function table describing one effect
+ *
+ * Each segment running the effect gets its own state block of
+ * stateSize(length) bytes, zeroed before begin() is called. The block is
+ * plain memory that may be copied, so keep it trivially copyable.
+ */
+struct LedEffectType {
+  const char* name;
+  size_t (*stateSize)(uint16_t length);                   // nullptr: no state
+  void (*begin)(LedEffectContext& context, void* state);  // nullptr: nothing to prepare
+  bool (*render)(LedEffectContext& context, void* state); // true when pixels changed
+};
+
+/**
+ * @brief Table of all effects, indexed by LedEffect
+ *
+ * The built-in effects are registered statically. Application effects
+ * are added once at startup, before any strip uses them; the type must
+ * stay alive for the rest of the program (a static or global).
+ */
+class LedEffectRegistry {
+ public:
+  static constexpr uint8_t kMaxEffects = 32;
+
+  /**
+   * @brief Register an effect
+   * @param type Function table of the effect
+   * @return Id to use in LedEffectConfig::effect, LedEffect::Off if the table is full
+   */
+  static LedEffect add(const LedEffectType& type);
+
+  /**
+   * @brief Look up an effect
+   * @return Function table, or nullptr for an unknown id
+   */
+  static const LedEffectType* find(LedEffect effect);
+
+  /**
+   * @brief Number of registered effects, built-ins included
+   */
+  static uint8_t count() { return count_.load(std::memory_order_acquire); }
+
+ private:
+  static const LedEffectType* types_[kMaxEffects];
+  static std::atomic<uint8_t> count_;
+};
+
+}  // namespace espmods::led
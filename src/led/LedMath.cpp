@@ -0,0 +1,97 @@
+#include "LedMath.h"
+
+namespace espmods::led {
+
+const uint8_t kSine8Table[256] = {
+    128, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+    176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+    218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+    245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+    255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+    245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+    218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+    176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+    128, 124, 121, 118, 115, 112, 109, 106, 103, 100,  97,  93,  90,  88,  85,  82,
+     79,  76,  73,  70,  67,  65,  62,  59,  57,  54,  52,  49,  47,  44,  42,  40,
+     37,  35,  33,  31,  29,  27,  25,  23,  21,  20,  18,  17,  15,  14,  12,  11,
+     10,   9,   7,   6,   5,   5,   4,   3,   2,   2,   1,   1,   1,   0,   0,   0,
+      0,   0,   0,   0,   1,   1,   1,   2,   2,   3,   4,   5,   5,   6,   7,   9,
+     10,  11,  12,  14,  15,  17,  18,  20,  21,  23,  25,  27,  29,  31,  33,  35,
+     37,  40,  42,  44,  47,  49,  52,  54,  57,  59,  62,  65,  67,  70,  73,  76,
+     79,  82,  85,  88,  90,  93,  97, 100, 103, 106, 109, 112, 115, 118, 121, 124,
+};
+
+RgbColor hueToRgb(uint16_t hue) {
+#if ESPMODS_LED_FIXED_POINT
+  // Six 60-degree sectors; the ramp inside each sector is an 8-bit fraction
+  uint32_t scaled = static_cast<uint32_t>(hue) * 6;
+  uint8_t sector = scaled >> 16;
+  uint8_t rising = (scaled >> 8) & 0xFF;
+  uint8_t falling = 255 - rising;
+  switch (sector) {
+    case 0: return RgbColor(255, rising, 0);
+    case 1: return RgbColor(falling, 255, 0);
+    case 2: return RgbColor(0, 255, rising);
+    case 3: return RgbColor(0, falling, 255);
+    case 4: return RgbColor(rising, 0, 255);
+    default: return RgbColor(255, 0, falling);
+  }
+#else
+  float degrees = hue / 65536.0f * 360.0f;
+  float x = 1.0f - fabsf(fmodf(degrees / 60.0f, 2.0f) - 1.0f);
+  float r, g, b;
+  if (degrees < 60) { r = 1.0f; g = x; b = 0; }
+  else if (degrees < 120) { r = x; g = 1.0f; b = 0; }
+  else if (degrees < 180) { r = 0; g = 1.0f; b = x; }
+  else if (degrees < 240) { r = 0; g = x; b = 1.0f; }
+  else if (degrees < 300) { r = x; g = 0; b = 1.0f; }
+  else { r = 1.0f; g = 0; b = x; }
+  return RgbColor(r * 255, g * 255, b * 255);
+#endif
+}
+
+void fillGradient(RgbColor* out, uint16_t length, const RgbColor& from, const RgbColor& to) {
+  // Q16.16 blend position, rounded so the last pixel lands exactly on to
+  uint32_t step = length > 1 ? (255UL << 16) / (length - 1) : 0;
+  uint32_t position = 0x8000;
+  for (uint16_t i = 0; i < length; i++) {
+    out[i] = blendColor(from, to, position >> 16);
+    position += step;
+  }
+}
+
+void fillGradient(LedColor* out, uint16_t length, const LedColor& from, const LedColor& to) {
+  // One rounded Q0.16 position per pixel, exact at both ends
+  uint32_t span = length > 1 ? length - 1 : 1;
+  for (uint16_t i = 0; i < length; i++) {
+    uint32_t fraction = static_cast<uint32_t>(((static_cast<uint64_t>(i) << 16) + span / 2) / span);
+    out[i] = LedColor(lerp16(from.R, to.R, fraction), lerp16(from.G, to.G, fraction),
+                      lerp16(from.B, to.B, fraction));
+  }
+}
+
+const RgbColor* hueWheel() {
+  static RgbColor wheel[256];
+  static const bool baked = [] {
+    for (uint16_t k = 0; k < 256; k++) {
+      wheel[k] = hueToRgb(k << 8);
+    }
+    return true;
+  }();
+  (void)baked;
+  return wheel;
+}
+
+const uint16_t* gammaTable() {
+  static uint16_t table[256];
+  static const bool baked = [] {
+    for (uint16_t k = 0; k < 256; k++) {
+      table[k] = static_cast<uint16_t>(powf(k / 255.0f, 1.0f / 0.45f) * 65280.0f + 0.5f);
+    }
+    return true;
+  }();
+  (void)baked;
+  return table;
+}
+
+}  // namespace espmods::led
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <Arduino.h>
+#include <NeoPixelBusLg.h>
+
+// Select the LED render arithmetic at build time:
+//   1 (default) - Q8.8/Q16.16 fixed-point with a sine lookup table
+//   0           - float helpers (sinf/fmodf per call)
+// Override with -DESPMODS_LED_FIXED_POINT=0 to compare frame times.
+#ifndef ESPMODS_LED_FIXED_POINT
+#define ESPMODS_LED_FIXED_POINT 1
+#endif
+
+namespace espmods::led {
+
+/**
+ * @brief Working colour with Q8.8 channels (0..255.0)
+ *
+ * Frame buffers hold this type so scaled and blended values keep their
+ * fraction until the output stage rounds or dithers them. 8-bit colours
+ * widen implicitly and exactly.
+ */
+struct LedColor {
+  LedColor() : R(0), G(0), B(0) {}
+  LedColor(uint16_t r, uint16_t g, uint16_t b) : R(r), G(g), B(b) {}
+  LedColor(const RgbColor& color) : R(color.R << 8), G(color.G << 8), B(color.B << 8) {}
+
+  RgbColor toRgb() const { return RgbColor(R >> 8, G >> 8, B >> 8); }
+
+  bool operator==(const LedColor& other) const { return R == other.R && G == other.G && B == other.B; }
+  bool operator!=(const LedColor& other) const { return !(*this == other); }
+
+  uint16_t R;
+  uint16_t G;
+  uint16_t B;
+};
+
+/**
+ * @brief 256-entry sine table, one full period mapped to 0..255
+ *
+ * kSine8Table[i] = 127.5 + 127.5 * sin(2 * pi * i / 256)
+ */
+extern const uint8_t kSine8Table[256];
+
+/**
+ * @brief Exact integer division by 255 for products of two 8-bit values
+ */
+inline uint8_t div255(uint16_t value) {
+  return static_cast<uint8_t>((value + 1 + (value >> 8)) >> 8);
+}
+
+/**
+ * @brief Scale an 8-bit value by an 8-bit factor (255 == 1.0)
+ */
+inline uint8_t scale8(uint8_t value, uint8_t scale) {
+#if ESPMODS_LED_FIXED_POINT
+  return div255(static_cast<uint16_t>(value) * scale);
+#else
+  return static_cast<uint8_t>(value * (scale / 255.0f));
+#endif
+}
+
+/**
+ * @brief Scale an 8-bit value by an 8-bit factor into Q8.8, keeping the fraction
+ */
+inline uint16_t scale8To16(uint8_t value, uint8_t scale) {
+  // value * scale / 255 in Q8.8 is x * 256 / 255 == x + x / 255
+  uint16_t x = static_cast<uint16_t>(value) * scale;
+  return x + div255(x);
+}
+
+/**
+ * @brief Linear blend between two Q8.8 values (amount 0 -> a, 255 -> b)
+ */
+inline uint16_t blend16(uint16_t a, uint16_t b, uint8_t amount) {
+  return static_cast<uint16_t>((static_cast<uint32_t>(a) * (255 - amount) +
+                                static_cast<uint32_t>(b) * amount) / 255);
+}
+
+/**
+ * @brief Linear blend between two Q8.8 values by a Q0.16 fraction (65536 -> b)
+ */
+inline uint16_t lerp16(uint16_t a, uint16_t b, uint32_t fraction) {
+  int64_t delta = static_cast<int32_t>(b) - a;
+  return static_cast<uint16_t>(a + ((delta * fraction + 0x8000) >> 16));
+}
+
+/**
+ * @brief Linear blend between two 8-bit values (amount 0 -> a, 255 -> b)
+ */
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amount) {
+#if ESPMODS_LED_FIXED_POINT
+  return div255(static_cast<uint16_t>(a) * (255 - amount) + static_cast<uint16_t>(b) * amount);
+#else
+  float ratio = amount / 255.0f;
+  return static_cast<uint8_t>(a + (b - a) * ratio);
+#endif
+}
+
+/**
+ * @brief Sine of a Q0.16 phase (0..65535 is one period), mapped to 0..255
+ */
+inline uint8_t sin16To8(uint16_t phase) {
+#if ESPMODS_LED_FIXED_POINT
+  // Upper byte indexes the table, lower byte interpolates to the next entry
+  uint8_t index = phase >> 8;
+  uint8_t frac = phase & 0xFF;
+  int16_t a = kSine8Table[index];
+  int16_t b = kSine8Table[static_cast<uint8_t>(index + 1)];
+  return static_cast<uint8_t>(a + (((b - a) * frac) >> 8));
+#else
+  float turns = phase / 65536.0f;
+  return static_cast<uint8_t>(sinf(turns * TWO_PI) * 127.5f + 127.5f);
+#endif
+}
+
+/**
+ * @brief Position of timeMs within period as a Q0.16 fraction
+ */
+inline uint16_t phase16(uint32_t timeMs, uint32_t period) {
+  if (period == 0) {
+    return 0;
+  }
+  return static_cast<uint16_t>((static_cast<uint64_t>(timeMs % period) << 16) / period);
+}
+
+/**
+ * @brief Sine wave oscillating 0..255 over the given period
+ */
+inline uint8_t wave8(uint32_t timeMs, uint32_t period) {
+  return sin16To8(phase16(timeMs, period));
+}
+
+/**
+ * @brief Unscaled colour from a 24-bit 0xRRGGBB value
+ */
+inline RgbColor hexToRgb(uint32_t color) {
+  return RgbColor((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+}
+
+/**
+ * @brief Scale every channel of a colour by an 8-bit factor
+ */
+inline RgbColor scaleColor(const RgbColor& color, uint8_t scale) {
+  return RgbColor(scale8(color.R, scale), scale8(color.G, scale), scale8(color.B, scale));
+}
+
+/**
+ * @brief Scale an 8-bit colour into a Q8.8 working colour without rounding
+ */
+inline LedColor scaleColor16(const RgbColor& color, uint8_t scale) {
+  return LedColor(scale8To16(color.R, scale), scale8To16(color.G, scale), scale8To16(color.B, scale));
+}
+
+/**
+ * @brief Blend two working colours (amount 0 -> color1, 255 -> color2)
+ */
+inline LedColor blendColor(const LedColor& color1, const LedColor& color2, uint8_t amount) {
+  return LedColor(blend16(color1.R, color2.R, amount),
+                  blend16(color1.G, color2.G, amount),
+                  blend16(color1.B, color2.B, amount));
+}
+
+/**
+ * @brief Blend two colours (amount 0 -> color1, 255 -> color2)
+ */
+inline RgbColor blendColor(const RgbColor& color1, const RgbColor& color2, uint8_t amount) {
+  return RgbColor(blend8(color1.R, color2.R, amount),
+                  blend8(color1.G, color2.G, amount),
+                  blend8(color1.B, color2.B, amount));
+}
+
+/**
+ * @brief Fill length pixels with a linear gradient from one colour to another
+ *
+ * The first pixel is from and the last exactly to.
+ */
+void fillGradient(RgbColor* out, uint16_t length, const RgbColor& from, const RgbColor& to);
+
+/**
+ * @brief Fill length pixels with a linear gradient, keeping Q8.8 precision
+ */
+void fillGradient(LedColor* out, uint16_t length, const LedColor& from, const LedColor& to);
+
+/**
+ * @brief Black-body style ramp for heat values: black, red, yellow, white
+ */
+inline RgbColor heatColor(uint8_t heat) {
+  // Scale to 0..191 so each third of the ramp gets 64 steps
+  uint8_t t192 = scale8(heat, 191);
+  uint8_t ramp = (t192 & 0x3F) << 2;
+  if (t192 & 0x80) {
+    return RgbColor(255, 255, ramp);
+  }
+  if (t192 & 0x40) {
+    return RgbColor(255, ramp, 0);
+  }
+  return RgbColor(ramp, 0, 0);
+}
+
+/**
+ * @brief Reverse the bit order of a byte (low-discrepancy frame sequence)
+ */
+inline uint8_t reverse8(uint8_t value) {
+  value = (value & 0xF0) >> 4 | (value & 0x0F) << 4;
+  value = (value & 0xCC) >> 2 | (value & 0x33) << 2;
+  return (value & 0xAA) >> 1 | (value & 0x55) << 1;
+}
+
+/**
+ * @brief Fully saturated colour wheel; hue is a Q0.16 turn
+ */
+RgbColor hueToRgb(uint16_t hue);
+
+/**
+ * @brief 256-entry colour wheel, baked on first use and shared by all strips
+ */
+const RgbColor* hueWheel();
+
+/**
+ * @brief LED gamma curve in Q8.8 (0..255.0), baked on first use
+ *
+ * Same exponent as NeoPixelBus' gamma table, kept at 16 bits so dim
+ * levels retain a fraction for dithering instead of rounding to zero.
+ */
+const uint16_t* gammaTable();
+
+}  // namespace espmods::led
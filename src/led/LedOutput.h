@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Arduino.h>
+#include <NeoPixelBusLg.h>
+
+#include <type_traits>
+
+namespace espmods::led {
+
+/**
+ * @brief Final levels of one pixel in the output's channel depth
+ *
+ * 0..255 for 8-bit outputs, 0..65535 for 16-bit outputs. W is only
+ * non-zero for outputs with a white channel.
+ */
+struct LedLevels {
+  uint16_t R;
+  uint16_t G;
+  uint16_t B;
+  uint16_t W;
+};
+
+/**
+ * @brief Destination for frames produced by LedStrip's output stage
+ *
+ * Receives final strip levels (brightness, gamma, white extraction and
+ * dithering already applied) one pixel at a time, then show() once per
+ * frame. depth() and hasWhite() tell the output stage what to produce.
+ */
+class LedOutput {
+ public:
+  virtual ~LedOutput() = default;
+  virtual void begin() = 0;
+  virtual void setPixel(uint16_t index, const LedLevels& levels) = 0;
+  virtual void show() = 0;
+
+  /**
+   * @brief Bits per channel the output accepts (8 or 16)
+   */
+  virtual uint8_t depth() const { return 8; }
+
+  /**
+   * @brief Whether the output has a separate white channel
+   */
+  virtual bool hasWhite() const { return false; }
+};
+
+/**
+ * @brief LedOutput driving a NeoPixelBus strip
+ *
+ * The colour feature and method select the wire order, channel layout and
+ * peripheral at compile time; RGB, RGBW and their 16-bit variants
+ * (e.g. NeoGrbwFeature, NeoGrb48Feature) are supported. The library's
+ * gamma table is disabled because the strip's output stage applies gamma
+ * itself.
+ */
+template <typename T_COLOR_FEATURE, typename T_METHOD>
+class NeoPixelOutput final : public LedOutput {
+  using ColorObject = typename T_COLOR_FEATURE::ColorObject;
+  static constexpr bool kWhite =
+      std::is_same<ColorObject, RgbwColor>::value || std::is_same<ColorObject, Rgbw64Color>::value;
+  static constexpr bool kWide =
+      std::is_same<ColorObject, Rgb48Color>::value || std::is_same<ColorObject, Rgbw64Color>::value;
+
+ public:
+  NeoPixelOutput(uint16_t count, uint8_t pin) : bus_(count, pin) {}
+
+  void begin() override { bus_.Begin(); }
+  void show() override { bus_.Show(); }
+  uint8_t depth() const override { return kWide ? 16 : 8; }
+  bool hasWhite() const override { return kWhite; }
+
+  void setPixel(uint16_t index, const LedLevels& levels) override {
+    if constexpr (kWhite) {
+      bus_.SetPixelColor(index, ColorObject(levels.R, levels.G, levels.B, levels.W));
+    } else {
+      bus_.SetPixelColor(index, ColorObject(levels.R, levels.G, levels.B));
+    }
+  }
+
+ private:
+  NeoPixelBusLg<T_COLOR_FEATURE, T_METHOD, NeoGammaNullMethod> bus_;
+};
+
+}  // namespace espmods::led
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <new>
+
+#include "LedMath.h"
+
+namespace espmods::led {
+
+/**
+ * @brief One block of working-colour pixels shared by several LED devices
+ *
+ * LedStrip and LedRing take their frame, transition and table buffers
+ * from a pool when constructed with one, so a device driving both makes
+ * a single allocation (or uses a single static array) instead of one per
+ * buffer. Size the pool with LedStrip::poolPixels() and
+ * LedRing::poolPixels(); the pool must outlive everything built from it.
+ */
+class LedPixelPool {
+ public:
+  /**
+   * @brief Pool on the heap
+   * @param capacity Number of pixels; check getCapacity() for failure
+   */
+  explicit LedPixelPool(size_t capacity)
+      : storage_(new (std::nothrow) LedColor[capacity]),
+        capacity_(storage_ != nullptr ? capacity : 0),
+        used_(0),
+        owned_(true) {}
+
+  /**
+   * @brief Pool over caller-provided storage, e.g. a static array
+   * @param storage Storage for capacity pixels
+   * @param capacity Number of pixels
+   */
+  LedPixelPool(LedColor* storage, size_t capacity)
+      : storage_(storage), capacity_(capacity), used_(0), owned_(false) {}
+
+  LedPixelPool(const LedPixelPool&) = delete;
+  LedPixelPool& operator=(const LedPixelPool&) = delete;
+
+  ~LedPixelPool() {
+    if (owned_) {
+      delete[] storage_;
+    }
+  }
+
+  /**
+   * @brief Reserve pixels for the lifetime of the pool
+   * @param pixels Number of pixels
+   * @return Cleared pixels, nullptr if the pool has no room left
+   */
+  LedColor* take(size_t pixels) {
+    if (pixels == 0 || pixels > capacity_ - used_) {
+      return nullptr;
+    }
+    LedColor* block = storage_ + used_;
+    used_ += pixels;
+    for (size_t i = 0; i < pixels; i++) {
+      block[i] = LedColor();
+    }
+    return block;
+  }
+
+  size_t getCapacity() const { return capacity_; }
+  size_t getUsed() const { return used_; }
+
+ private:
+  LedColor* storage_;
+  size_t capacity_;
+  size_t used_;
+  bool owned_;
+};
+
+}  // namespace espmods::led
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+
+namespace espmods::led {
+
+/**
+ * @brief Fast seedable pseudo-random generator for LED effects
+ *
+ * xorshift32 with multiply-shift range reduction: a handful of shifts and
+ * XORs per draw instead of Arduino random(), which goes through the
+ * hardware RNG and a modulo. Not suitable for anything security related.
+ * A fixed seed gives a reproducible sequence for tests and benchmarks.
+ */
+class LedRandom {
+ public:
+  explicit LedRandom(uint32_t seed = kDefaultSeed) { setSeed(seed); }
+
+  /**
+   * @brief Restart the sequence from a seed (0 is replaced by the default)
+   */
+  void setSeed(uint32_t seed) { state_ = seed != 0 ? seed : kDefaultSeed; }
+
+  /**
+   * @brief Next 32 random bits
+   */
+  uint32_t next() {
+    uint32_t x = state_;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state_ = x;
+    return x;
+  }
+
+  /**
+   * @brief Random byte
+   */
+  uint8_t next8() { return next() >> 24; }
+
+  /**
+   * @brief Uniform value in [0, range)
+   */
+  uint16_t below(uint16_t range) {
+    return static_cast<uint16_t>(((next() >> 16) * static_cast<uint32_t>(range)) >> 16);
+  }
+
+  /**
+   * @brief Uniform value in [low, high), low if the range is empty
+   */
+  uint16_t between(uint16_t low, uint16_t high) {
+    return high > low ? low + below(high - low) : low;
+  }
+
+ private:
+  static constexpr uint32_t kDefaultSeed = 0x9E3779B9;
+  uint32_t state_;
+};
+
+}  // namespace espmods::led
@@ -4,89 +4,249 @@
 
 namespace espmods::led {
 
+namespace {
+
+// Brushing highlight: 0.6 away from it, up to 1.0 on it (Q0.8)
+constexpr uint32_t kHighlightBase = 154;
+constexpr uint32_t kHighlightGain = 102;
+constexpr int32_t kOnePixel = 256;  // Q8.8
+constexpr uint32_t kIdlePeriodMs = 4000;
+
+}  // namespace
+
 LedRing::LedRing(uint8_t pin, uint16_t count, uint8_t brightness)
-    : strip_(count, pin),
+    : LedRing(*new NeoPixelOutput<NeoGrbFeature, NeoEsp32I2s0800KbpsMethod>(count, pin), count, brightness,
+              nullptr) {
+  ownsOutput_ = true;
+}
+
+LedRing::LedRing(LedOutput& output, uint16_t count, uint8_t brightness, LedColor* buffers)
+    : output_(&output),
+      ownsOutput_(false),
+      ownsBuffers_(buffers == nullptr),
+      gamma_(gammaTable()),
       count_(count),
       brightness_(brightness),
+      random_(random(1, 0x7FFFFFFF)),
       gradientStart_(brightness, brightness, brightness),
-      gradientEnd_(brightness, brightness, brightness) {}
+      gradientEnd_(brightness, brightness, brightness),
+      gradient_(buffers != nullptr ? buffers : new LedColor[poolPixels(count)]),
+      frame_(gradient_ + count) {}
+
+LedRing::LedRing(LedOutput& output, uint16_t count, uint8_t brightness, LedPixelPool& pool)
+    : LedRing(output, count, brightness, pool.take(poolPixels(count))) {}
+
+LedRing::~LedRing() {
+  if (ownsBuffers_) {
+    delete[] gradient_;
+  }
+  if (ownsOutput_) {
+    delete output_;
+  }
+}
 
 void LedRing::begin() {
-  strip_.Begin();
-  strip_.Show();
+  output_->begin();
+  for (uint16_t i = 0; i < count_; ++i) {
+    frame_[i] = LedColor();
+    output_->setPixel(i, LedLevels{0, 0, 0, 0});
+  }
+  output_->show();
   idlePulseStart_ = millis();
+  lastTick_ = idlePulseStart_;
+}
+
+void LedRing::play(Animation animation, uint32_t durationMs, uint8_t priority) {
+  queue(animation, durationMs, priority, millis());
+}
+
+void LedRing::queue(Animation animation, uint32_t durationMs, uint8_t priority, uint32_t now) {
+  Slot& slot = slots_[static_cast<uint8_t>(animation)];
+  slot.queued = true;
+  slot.priority = priority;
+  slot.durationMs = durationMs;
+  slot.started = false;
+  slot.order = ++queueOrder_;
+  renderPending_ = true;
+  update(now);
 }
 
+void LedRing::stop(Animation animation) {
+  slots_[static_cast<uint8_t>(animation)].queued = false;
+  update(millis());
+}
 
 void LedRing::showIdleGlow(uint32_t millisNow) {
-  progressMode_ = false;
-  uint32_t period = 4000;
-  uint32_t elapsed = (millisNow - idlePulseStart_) % period;
-  float phase = static_cast<float>(elapsed) / period;
-  float intensity = sinf(phase * TWO_PI) * 0.5f + 0.5f;
-  for (uint16_t i = 0; i < count_; ++i) {
-    float fraction = count_ <= 1 ? 0.0f : static_cast<float>(i) / (count_ - 1);
-    strip_.SetPixelColor(i, gradientColor(fraction, intensity));
+  slots_[static_cast<uint8_t>(Animation::Progress)].queued = false;
+  if (!slots_[static_cast<uint8_t>(Animation::IdleGlow)].queued) {
+    queue(Animation::IdleGlow, 0, kPriorityIdle, millisNow);
+    return;
   }
-  strip_.Show();
+  // Already playing; callers polling this every loop get the tick rate
+  tick(millisNow);
 }
 
 void LedRing::showProgress(uint32_t elapsedSeconds, uint32_t totalSeconds) {
   float ratio = totalSeconds > 0 ? (float)elapsedSeconds / totalSeconds : 0.0f;
-  bool wasInProgress = progressMode_;
-  progressMode_ = true;
+  bool wasInProgress = slots_[static_cast<uint8_t>(Animation::Progress)].queued;
   progressRatio_ = constrain(ratio, 0.0f, 1.0f);
   if (!wasInProgress || progressRatio_ <= 0.0f) {
     highlightPosition_ = 0.0f;
     highlightDirection_ = 1;
   }
   lastAnimationUpdate_ = millis();
-  renderProgressFrame(lastAnimationUpdate_);
+  if (!wasInProgress) {
+    play(Animation::Progress, 0, kPriorityProgress);
+    return;
+  }
+  renderPending_ = true;
+  update(lastAnimationUpdate_);
 }
 
 void LedRing::showConfetti(uint32_t millisNow) {
-  progressMode_ = false;
-  confettiUntil_ = millisNow + 3000;
+  // Confetti ends the progress display; an idle glow resumes afterwards
+  slots_[static_cast<uint8_t>(Animation::Progress)].queued = false;
+  queue(Animation::Confetti, kConfettiMs, kPriorityEffect, millisNow);
 }
 
 void LedRing::clear() {
-  progressMode_ = false;
-  for (uint16_t i = 0; i < count_; ++i) {
-    strip_.SetPixelColor(i, RgbColor(0));
+  for (uint8_t a = 0; a < kAnimationCount; ++a) {
+    slots_[a].queued = false;
   }
-  strip_.Show();
+  renderPending_ = true;
+  update(millis());
 }
 
-void LedRing::loop() {
-  if (confettiUntil_ == 0) {
-    if (progressMode_) {
-      renderProgressFrame(millis());
-    }
+void LedRing::loop() { tick(millis()); }
+
+void LedRing::tick(uint32_t now) {
+  if (now - lastTick_ < frameIntervalMs_) {
     return;
   }
-  if (millis() > confettiUntil_) {
-    confettiUntil_ = 0;
-    clear();
+  lastTick_ = now;
+  update(now);
+}
+
+void LedRing::setTargetFps(uint8_t fps) {
+  frameIntervalMs_ = fps > 0 ? 1000 / fps : 0;
+}
+
+void LedRing::update(uint32_t now) {
+  Animation active = schedule(now);
+  if (active != active_) {
+    active_ = active;
+    renderPending_ = true;
+    lastAnimationUpdate_ = now;
+  }
+  // Static animations only render when something changed
+  if (!renderPending_ && !isAnimated(active_)) {
     return;
   }
+  renderPending_ = false;
+  render(active_, now);
+}
+
+LedRing::Animation LedRing::schedule(uint32_t now) {
+  // Highest priority wins, the latest queued among equals; expired
+  // animations leave the queue and the next one is considered
+  for (;;) {
+    int8_t best = -1;
+    for (uint8_t a = 0; a < kAnimationCount; ++a) {
+      const Slot& slot = slots_[a];
+      if (slot.queued && (best < 0 || slot.priority > slots_[best].priority ||
+                          (slot.priority == slots_[best].priority && slot.order > slots_[best].order))) {
+        best = a;
+      }
+    }
+    if (best < 0) {
+      return Animation::Off;
+    }
+    Slot& slot = slots_[best];
+    if (!slot.started) {
+      slot.started = true;
+      slot.startTime = now;
+    }
+    if (slot.durationMs == 0 || now - slot.startTime < slot.durationMs) {
+      return static_cast<Animation>(best);
+    }
+    slot.queued = false;
+  }
+}
+
+bool LedRing::isAnimated(Animation animation) const {
+  switch (animation) {
+    case Animation::IdleGlow:
+    case Animation::Confetti:
+      return true;
+    case Animation::Progress:
+      return brushingActive_;
+    default:
+      return false;
+  }
+}
+
+void LedRing::render(Animation animation, uint32_t now) {
+  switch (animation) {
+    case Animation::IdleGlow:
+      renderIdleGlow(now);
+      break;
+    case Animation::Progress:
+      renderProgressFrame(now);
+      break;
+    case Animation::Confetti:
+      renderConfetti();
+      break;
+    default:
+      renderOff();
+      break;
+  }
+}
+
+void LedRing::renderIdleGlow(uint32_t millisNow) {
+  progressValid_ = false;
+  // The glow spans the whole ring
+  if (gradientPixels_ != count_) {
+    buildGradient(count_);
+  }
+  // Sine 0..255 from the shared table, widened to Q0.16
+  uint32_t scale = static_cast<uint32_t>(wave8(millisNow - idlePulseStart_, kIdlePeriodMs)) * 257;
   for (uint16_t i = 0; i < count_; ++i) {
-    uint8_t r = random(0, brightness_ + 1);
-    uint8_t g = random(0, brightness_ + 1);
-    uint8_t b = random(0, brightness_ + 1);
-    strip_.SetPixelColor(i, RgbColor(r, g, b));
+    setPixel(i, scaleGradient(i, scale));
   }
+  show();
+}
 
-  strip_.Show();
+void LedRing::renderConfetti() {
+  progressValid_ = false;
+  // One PRNG draw per pixel, each byte scaled to 0..brightness
+  uint16_t range = brightness_ + 1;
+  for (uint16_t i = 0; i < count_; ++i) {
+    uint32_t bits = random_.next();
+    uint8_t r = ((bits & 0xFF) * range) >> 8;
+    uint8_t g = (((bits >> 8) & 0xFF) * range) >> 8;
+    uint8_t b = (((bits >> 16) & 0xFF) * range) >> 8;
+    setPixel(i, RgbColor(r, g, b));
+  }
+  show();
 }
 
-void LedRing::setGradientColors(uint32_t startColor, uint32_t endColor) {
-  gradientStart_ = colorFromHex(startColor);
-  gradientEnd_ = colorFromHex(endColor);
-  if (progressMode_) {
-    renderProgressFrame(millis());
-  } else {
-    showIdleGlow(millis());
+void LedRing::renderOff() {
+  progressValid_ = false;
+  for (uint16_t i = 0; i < count_; ++i) {
+    setPixel(i, RgbColor(0));
   }
+  show();
+}
+
+void LedRing::seedRandom(uint32_t seed) { random_.setSeed(seed); }
+
+void LedRing::setGradientColors(uint32_t startColor, uint32_t endColor) {
+  gradientStart_ = hexToRgb(startColor);
+  gradientEnd_ = hexToRgb(endColor);
+  gradientPixels_ = 0;
+  progressValid_ = false;
+  renderPending_ = true;
+  update(millis());
 }
 
 void LedRing::setBrushingActive(bool active) {
@@ -95,30 +255,80 @@ void LedRing::setBrushingActive(bool active) {
   }
   brushingActive_ = active;
   lastAnimationUpdate_ = millis();
+  // The highlight appears or goes away at the next tick
+  renderPending_ = true;
+}
+
+void LedRing::buildGradient(uint16_t litPixels) {
+  // Q8.8 with brightness applied, so intensity scaling later rounds only
+  // once; pixels past the lit ones (a sliver of partial progress) take the
+  // end colour
+  LedColor start = scaleColor16(gradientStart_, brightness_);
+  LedColor end = litPixels > 1 ? scaleColor16(gradientEnd_, brightness_) : start;
+  uint16_t lit = constrain(litPixels, static_cast<uint16_t>(1), count_);
+  fillGradient(gradient_, lit, start, end);
+  for (uint16_t i = lit; i < count_; ++i) {
+    gradient_[i] = end;
+  }
+  gradientPixels_ = litPixels;
+}
+
+RgbColor LedRing::scaleGradient(uint16_t index, uint32_t intensity) const {
+  // Q8.8 colour times Q0.16 intensity, rounded to 8 bits
+  const LedColor& color = gradient_[index];
+  return RgbColor((color.R * intensity + 0x800000) >> 24, (color.G * intensity + 0x800000) >> 24,
+                  (color.B * intensity + 0x800000) >> 24);
+}
+
+RgbColor LedRing::progressPixel(uint16_t index, const ProgressState& state) const {
+  uint32_t intensity = 0;
+  if (index < state.fullPixels) {
+    intensity = 256;
+  } else if (index == state.fullPixels) {
+    intensity = state.partial;
+  }
+  if (intensity == 0) {
+    return RgbColor(0);
+  }
+  uint32_t modulation = 256;
+  if (state.modulated) {
+    int32_t distance = abs(static_cast<int32_t>(index) * kOnePixel - state.highlight);
+    modulation = kHighlightBase;
+    if (distance < kOnePixel) {
+      modulation += ((kOnePixel - distance) * kHighlightGain) >> 8;
+    }
+  }
+  return scaleGradient(index, intensity * modulation);
 }
 
-RgbColor LedRing::colorFromHex(uint32_t color) const {
-  uint8_t r = (color >> 16) & 0xFF;
-  uint8_t g = (color >> 8) & 0xFF;
-  uint8_t b = color & 0xFF;
-  return RgbColor(r, g, b);
+void LedRing::setPixel(uint16_t index, const RgbColor& color) {
+  LedColor value(color);
+  if (frame_[index] == value) {
+    return;
+  }
+  frame_[index] = value;
+  frameDirty_ = true;
+  uint16_t r = gamma_[color.R];
+  uint16_t g = gamma_[color.G];
+  uint16_t b = gamma_[color.B];
+  if (output_->depth() == 16) {
+    // Q8.8 to 0..65535
+    output_->setPixel(index, LedLevels{static_cast<uint16_t>(r + (r >> 8)), static_cast<uint16_t>(g + (g >> 8)),
+                                       static_cast<uint16_t>(b + (b >> 8)), 0});
+  } else {
+    output_->setPixel(index, LedLevels{static_cast<uint16_t>((r + 0x80) >> 8), static_cast<uint16_t>((g + 0x80) >> 8),
+                                       static_cast<uint16_t>((b + 0x80) >> 8), 0});
+  }
 }
 
-RgbColor LedRing::gradientColor(float fraction, float intensity) const {
-  fraction = constrain(fraction, 0.0f, 1.0f);
-  intensity = constrain(intensity, 0.0f, 1.0f);
-  float brightnessScale = static_cast<float>(brightness_) / 255.0f;
-  float startR = gradientStart_.R * brightnessScale;
-  float startG = gradientStart_.G * brightnessScale;
-  float startB = gradientStart_.B * brightnessScale;
-  float endR = gradientEnd_.R * brightnessScale;
-  float endG = gradientEnd_.G * brightnessScale;
-  float endB = gradientEnd_.B * brightnessScale;
-  float r = (startR + (endR - startR) * fraction) * intensity;
-  float g = (startG + (endG - startG) * fraction) * intensity;
-  float b = (startB + (endB - startB) * fraction) * intensity;
-  return RgbColor(static_cast<uint8_t>(roundf(r)), static_cast<uint8_t>(roundf(g)),
-                  static_cast<uint8_t>(roundf(b)));
+void LedRing::show() {
+  if (!frameDirty_) {
+    framesSkipped_++;
+    return;
+  }
+  output_->show();
+  frameDirty_ = false;
+  framesShown_++;
 }
 
 void LedRing::renderProgressFrame(uint32_t millisNow) {
@@ -153,31 +363,32 @@ void LedRing::renderProgressFrame(uint32_t millisNow) {
   }
   lastAnimationUpdate_ = millisNow;
 
-  for (uint16_t i = 0; i < count_; ++i) {
-    float intensity = 0.0f;
-    if (i < fullPixels) {
-      intensity = 1.0f;
-    } else if (i == fullPixels && partialPixel > 0.0f && fullPixels < count_) {
-      intensity = partialPixel;
-    }
+  ProgressState state;
+  state.fullPixels = fullPixels;
+  if (fullPixels < count_ && partialPixel > 0.0f) {
+    state.partial = static_cast<uint8_t>(min(255L, lroundf(partialPixel * 256.0f)));
+  }
+  state.modulated = brushingActive_ && effectivePixels > 0;
+  state.highlight = state.modulated ? lroundf(highlightPosition_ * kOnePixel) : 0;
 
-    if (intensity > 0.0f) {
-      float fraction = effectivePixels <= 1 ? 0.0f : static_cast<float>(i) / (effectivePixels - 1);
-      float modulation = 1.0f;
-      if (brushingActive_ && effectivePixels > 0) {
-        float distance = fabsf(static_cast<float>(i) - highlightPosition_);
-        if (distance < 1.0f) {
-          float highlight = 1.0f - distance;
-          modulation = 0.6f + 0.4f * highlight;
-        } else {
-          modulation = 0.6f;
-        }
-      }
-      strip_.SetPixelColor(i, gradientColor(fraction, intensity * modulation));
-    } else {
-      strip_.SetPixelColor(i, RgbColor(0));
-    }
+  uint16_t first = 0;
+  uint16_t end = count_;
+  if (gradientPixels_ != effectivePixels) {
+    buildGradient(effectivePixels);
+  } else if (progressValid_ && state.fullPixels == progress_.fullPixels && state.partial == progress_.partial &&
+             state.modulated == progress_.modulated) {
+    // Only the highlight moved: it touches the two pixels around its old
+    // and its new position
+    int32_t low = min(state.highlight, progress_.highlight);
+    int32_t high = max(state.highlight, progress_.highlight);
+    first = state.highlight == progress_.highlight ? 0 : low / kOnePixel;
+    end = state.highlight == progress_.highlight ? 0 : min<int32_t>(high / kOnePixel + 2, count_);
   }
-  strip_.Show();
+  for (uint16_t i = first; i < end; ++i) {
+    setPixel(i, progressPixel(i, state));
+  }
+  progress_ = state;
+  progressValid_ = true;
+  show();
+}
 }
-}
\ No newline at end of file
@@ -1,40 +1,235 @@
 #pragma once
 
 #include <Arduino.h>
-#include <NeoPixelBusLg.h>
+
+#include "LedMath.h"
+#include "LedOutput.h"
+#include "LedPixelPool.h"
+#include "LedRandom.h"
 
 namespace espmods::led {
 
+/**
+ * @brief Progress ring with idle glow, brushing highlight and confetti
+ *
+ * The gradient across the lit pixels is kept in a table that is only
+ * rebuilt when the lit length or the colours change, so a frame costs
+ * one integer scale per pixel. Progress frames recompute only the pixels
+ * that can differ from the last frame (the partial pixel and the two
+ * around the old and new highlight), and Show() is skipped when no pixel
+ * changed.
+ *
+ * Animations are scheduled: each one is queued with a priority and an
+ * optional duration, and the highest-priority queued animation plays
+ * until it expires or is stopped, after which the next one resumes
+ * (confetti over progress over the idle glow by default). loop() ticks
+ * the scheduler at the target frame rate and returns straight away
+ * between ticks or while the active animation is static, so it can be
+ * called freely and costs next to nothing when the ring is idle.
+ *
+ * The ring drives a LedOutput like LedStrip does and applies the shared
+ * gamma curve (gammaTable()) itself. Its gradient table and last-frame
+ * buffer can come from a LedPixelPool shared with the strips on the same
+ * device.
+ */
 class LedRing {
  public:
+  enum class Animation : uint8_t { Off, IdleGlow, Progress, Confetti };
+
+  // Default priorities used by the show*() helpers
+  static constexpr uint8_t kPriorityIdle = 0;
+  static constexpr uint8_t kPriorityProgress = 1;
+  static constexpr uint8_t kPriorityEffect = 2;
+  static constexpr uint32_t kConfettiMs = 3000;
+
+  /**
+   * @brief Constructor for a ring on its own NeoPixelBus output
+   * @param pin GPIO pin connected to the ring's data line
+   * @param count Number of LEDs in the ring
+   * @param brightness Brightness (0-255), folded into the gradient
+   */
   LedRing(uint8_t pin, uint16_t count, uint8_t brightness);
+
+  /**
+   * @brief Constructor for a ring with caller-provided output and buffers
+   *
+   * The output and buffers must outlive the ring.
+   * @param output Destination of the final pixel levels
+   * @param count Number of LEDs in the ring
+   * @param brightness Brightness (0-255), folded into the gradient
+   * @param buffers Storage for poolPixels(count) pixels, nullptr to
+   *                allocate them
+   */
+  LedRing(LedOutput& output, uint16_t count, uint8_t brightness, LedColor* buffers);
+
+  /**
+   * @brief Constructor for a ring whose buffers come from a shared pool
+   *
+   * A pool without room is a sizing mistake: the ring then allocates its
+   * buffers on the heap instead, like the pin constructor.
+   * @param output Destination of the final pixel levels
+   * @param count Number of LEDs in the ring
+   * @param brightness Brightness (0-255), folded into the gradient
+   * @param pool Pool with at least poolPixels(count) free pixels
+   */
+  LedRing(LedOutput& output, uint16_t count, uint8_t brightness, LedPixelPool& pool);
+
+  ~LedRing();
+
+  /**
+   * @brief Pool pixels a ring takes from a LedPixelPool (gradient table and last frame)
+   */
+  static constexpr size_t poolPixels(uint16_t count) { return 2 * static_cast<size_t>(count); }
+
+  LedRing(const LedRing&) = delete;
+  LedRing& operator=(const LedRing&) = delete;
+
   void begin();
+
+  /**
+   * @brief Queue an animation
+   *
+   * Queuing an animation that is already queued restarts it with the new
+   * duration and priority. Among equal priorities the latest one plays.
+   * The first frame renders right away if the animation becomes active.
+   * @param animation Animation to play
+   * @param durationMs Play time once active, 0 to play until stopped
+   * @param priority Higher values preempt lower ones
+   */
+  void play(Animation animation, uint32_t durationMs, uint8_t priority);
+
+  /**
+   * @brief Remove an animation from the queue; the next one resumes
+   */
+  void stop(Animation animation);
+
+  /**
+   * @brief Animation currently on the ring, Off when the queue is empty
+   */
+  Animation getActiveAnimation() const { return active_; }
+
+  /**
+   * @brief Queue the idle glow as the background animation, replacing progress
+   * @param millisNow Caller's millis(), the glow's start time if it becomes active
+   */
   void showIdleGlow(uint32_t millisNow);
+
+  /**
+   * @brief Update the progress ratio and queue the progress animation
+   */
   void showProgress(uint32_t elapsedSeconds, uint32_t totalSeconds);
+
+  /**
+   * @brief Play confetti for kConfettiMs, ending the progress display
+   * @param millisNow Caller's millis(); kConfettiMs counts from here if the
+   *                  confetti becomes active right away
+   */
   void showConfetti(uint32_t millisNow);
+
+  /**
+   * @brief Empty the queue and turn the ring off
+   */
   void clear();
+
+  /**
+   * @brief Advance the scheduler; call from the main loop as often as convenient
+   */
   void loop();
+
+  /**
+   * @brief Scheduler tick rate for animated frames
+   * @param fps Frames per second, 0 ticks on every loop()
+   */
+  void setTargetFps(uint8_t fps);
+
   void setGradientColors(uint32_t startColor, uint32_t endColor);
   void setBrushingActive(bool active);
+  void seedRandom(uint32_t seed);
+
+  /**
+   * @brief Number of frames pushed to the ring with Show()
+   */
+  uint32_t getFramesShown() const { return framesShown_; }
+
+  /**
+   * @brief Number of rendered frames skipped because no pixel changed
+   */
+  uint32_t getFramesSkipped() const { return framesSkipped_; }
 
  private:
+  // Inputs of the last progress frame; pixels they do not affect keep their colour
+  struct ProgressState {
+    uint16_t fullPixels = 0;
+    uint8_t partial = 0;       // Intensity of the pixel after the full ones, Q0.8
+    bool modulated = false;    // Brushing highlight active
+    int32_t highlight = 0;     // Highlight position, Q8.8 pixels
+  };
+
+  static constexpr uint8_t kAnimationCount = 4;
+  static constexpr uint8_t kDefaultTargetFps = 30;
+
+  // Queue entry; one slot per animation
+  struct Slot {
+    bool queued = false;
+    uint8_t priority = 0;
+    uint32_t durationMs = 0;     // 0 plays until stopped
+    uint32_t startTime = 0;      // When it first became active
+    bool started = false;
+    uint32_t order = 0;          // Queue order, breaks priority ties
+  };
+
+  // play() at a caller-supplied time
+  void queue(Animation animation, uint32_t durationMs, uint8_t priority, uint32_t now);
+  void tick(uint32_t now);
+  void update(uint32_t now);
+  Animation schedule(uint32_t now);
+  bool isAnimated(Animation animation) const;
+  void render(Animation animation, uint32_t now);
+  void renderIdleGlow(uint32_t millisNow);
+  void renderConfetti();
+  void renderOff();
   void renderProgressFrame(uint32_t millisNow);
-  RgbColor colorFromHex(uint32_t color) const;
-  RgbColor gradientColor(float fraction, float intensity) const;
+  RgbColor progressPixel(uint16_t index, const ProgressState& state) const;
+  void buildGradient(uint16_t litPixels);
+  RgbColor scaleGradient(uint16_t index, uint32_t intensity) const;
+  void setPixel(uint16_t index, const RgbColor& color);
+  void show();
 
-  NeoPixelBusLg<NeoGrbFeature, NeoEsp32I2s0800KbpsMethod> strip_;
+  LedOutput* output_;
+  bool ownsOutput_;              // output_ is ours to free
+  bool ownsBuffers_;             // gradient_ and frame_ are ours to free
+  const uint16_t* gamma_;        // Shared Q8.8 gamma curve
   uint16_t count_;
   uint8_t brightness_;
-  uint32_t confettiUntil_ = 0;
+  LedRandom random_;
   uint32_t idlePulseStart_ = 0;
-  bool idlePulseIncreasing_ = true;
   RgbColor gradientStart_;
   RgbColor gradientEnd_;
-  bool progressMode_ = false;
   float progressRatio_ = 0.0f;
   bool brushingActive_ = false;
   float highlightPosition_ = 0.0f;
   int8_t highlightDirection_ = 1;
   uint32_t lastAnimationUpdate_ = 0;
+
+  // Scheduler
+  Slot slots_[kAnimationCount];
+  uint32_t queueOrder_ = 0;
+  Animation active_ = Animation::Off;
+  bool renderPending_ = true;    // Active animation or its inputs changed
+  uint32_t frameIntervalMs_ = 1000 / kDefaultTargetFps;
+  uint32_t lastTick_ = 0;
+
+  // Gradient at full intensity with brightness applied, Q8.8, for
+  // gradientPixels_ lit pixels (0 when stale)
+  LedColor* gradient_;
+  uint16_t gradientPixels_ = 0;
+  ProgressState progress_;
+  bool progressValid_ = false;
+
+  // Colours on the ring before gamma, to detect frames that change nothing
+  LedColor* frame_;
+  bool frameDirty_ = false;
+  uint32_t framesShown_ = 0;
+  uint32_t framesSkipped_ = 0;
 };
 }
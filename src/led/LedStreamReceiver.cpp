@@ -0,0 +1,217 @@
+#include "LedStreamReceiver.h"
+
+namespace espmods::led {
+
+namespace {
+
+// DDP header: flags, sequence, data type, destination id, offset (u32),
+// length (u16), then an optional timecode (u32); big-endian
+constexpr size_t kDdpHeaderSize = 10;
+constexpr size_t kDdpTimecodeSize = 4;
+constexpr uint8_t kDdpVersionMask = 0xC0;
+constexpr uint8_t kDdpVersion1 = 0x40;
+constexpr uint8_t kDdpTimecode = 0x10;
+constexpr uint8_t kDdpReply = 0x04;
+constexpr uint8_t kDdpQuery = 0x02;
+constexpr uint8_t kDdpPush = 0x01;
+constexpr uint8_t kDdpSequenceMask = 0x0F;
+constexpr uint8_t kDdpTypeRgbw = 3;       // Data type bits 5-3
+constexpr uint8_t kDdpDisplay = 1;        // Default output device
+
+// E1.31 data packet: root layer, framing layer and DMP layer at fixed
+// offsets, DMX start code at 125 and channel data from 126
+constexpr size_t kE131HeaderSize = 126;
+constexpr size_t kE131SyncSize = 49;
+constexpr uint8_t kAcnPacketId[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+constexpr uint32_t kVectorRootData = 0x00000004;
+constexpr uint32_t kVectorRootExtended = 0x00000008;
+constexpr uint32_t kVectorFramingData = 0x00000002;
+constexpr uint32_t kVectorFramingSync = 0x00000001;
+constexpr uint8_t kVectorDmpSetProperty = 0x02;
+constexpr uint8_t kDmpAddressType = 0xA1;
+constexpr uint8_t kOptionPreview = 0x80;
+constexpr uint16_t kMaxChannels = 512;
+
+inline uint16_t read16(const uint8_t* data) {
+  return static_cast<uint16_t>(data[0] << 8 | data[1]);
+}
+
+inline uint32_t read32(const uint8_t* data) {
+  return static_cast<uint32_t>(data[0]) << 24 | data[1] << 16 | data[2] << 8 | data[3];
+}
+
+}  // namespace
+
+LedStreamReceiver::LedStreamReceiver(LedStrip& strip)
+    : strip_(strip),
+      firstUniverse_(1),
+      lastPacketTime_(0),
+      ddpSequence_(0),
+      e131Sequence_{},
+      e131SequenceValid_(0),
+      lastUniverse_(0),
+      syncUniverse_(0),
+      frameEnd_(0),
+      framePending_(false) {}
+
+bool LedStreamReceiver::begin(uint16_t timeoutMs) {
+  stats_ = Stats();
+  ddpSequence_ = 0;
+  e131SequenceValid_ = 0;
+  syncUniverse_ = 0;
+  frameEnd_ = 0;
+  framePending_ = false;
+  return strip_.beginStream(timeoutMs);
+}
+
+void LedStreamReceiver::end() {
+  framePending_ = false;
+  strip_.endStream();
+}
+
+bool LedStreamReceiver::handleDdp(const uint8_t* data, size_t length, uint32_t now) {
+  if (length < kDdpHeaderSize || (data[0] & kDdpVersionMask) != kDdpVersion1 ||
+      (data[0] & (kDdpQuery | kDdpReply)) != 0 || data[3] != kDdpDisplay) {
+    stats_.ignored++;
+    return false;
+  }
+  size_t header = data[0] & kDdpTimecode ? kDdpHeaderSize + kDdpTimecodeSize : kDdpHeaderSize;
+  uint8_t stride = ((data[2] >> 3) & 0x07) == kDdpTypeRgbw ? 4 : 3;
+  uint32_t offset = read32(data + 4);
+  uint16_t dataLength = read16(data + 8);
+  if (length < header + dataLength || offset % stride != 0) {
+    stats_.ignored++;
+    return false;
+  }
+  if (!acceptDdpSequence(data[1] & kDdpSequenceMask, now)) {
+    return false;
+  }
+  lastPacketTime_ = now;
+  stats_.packets++;
+  bool written = writePixels(offset / stride, data + header, dataLength / stride, stride);
+  if (data[0] & kDdpPush) {
+    commit();
+  }
+  return written;
+}
+
+bool LedStreamReceiver::handleE131(const uint8_t* data, size_t length, uint32_t now) {
+  if (length < kE131SyncSize || read16(data) != 0x0010 ||
+      memcmp(data + 4, kAcnPacketId, sizeof(kAcnPacketId)) != 0) {
+    stats_.ignored++;
+    return false;
+  }
+  uint32_t rootVector = read32(data + 18);
+  if (rootVector == kVectorRootExtended && read32(data + 40) == kVectorFramingSync) {
+    // Synchronization: show the frame that waits for this universe
+    if (!framePending_ || syncUniverse_ == 0 || read16(data + 45) != syncUniverse_) {
+      return false;
+    }
+    lastPacketTime_ = now;
+    commit();
+    return true;
+  }
+
+  uint16_t universe = read16(data + 113);
+  uint16_t channels = read16(data + 123) - 1;  // The count includes the start code
+  if (rootVector != kVectorRootData || length < kE131HeaderSize || read32(data + 40) != kVectorFramingData ||
+      data[117] != kVectorDmpSetProperty || data[118] != kDmpAddressType || data[125] != 0 ||
+      (data[112] & kOptionPreview) != 0 || channels > kMaxChannels || length < kE131HeaderSize + channels ||
+      universe < firstUniverse_ || universe - firstUniverse_ >= kMaxUniverses) {
+    stats_.ignored++;
+    return false;
+  }
+  uint8_t index = universe - firstUniverse_;
+  if (!acceptE131Sequence(index, data[111], now)) {
+    return false;
+  }
+  lastPacketTime_ = now;
+  stats_.packets++;
+
+  // Without sync, a universe at or before the previous one starts the
+  // sender's next frame, so a sender covering fewer pixels still shows
+  if (framePending_ && syncUniverse_ == 0 && index <= lastUniverse_) {
+    commit();
+  }
+  lastUniverse_ = index;
+  syncUniverse_ = read16(data + 109);
+  bool written = writePixels(static_cast<uint32_t>(index) * kE131PixelsPerUniverse, data + kE131HeaderSize,
+                             min<uint16_t>(channels / 3, kE131PixelsPerUniverse), 3);
+  if (syncUniverse_ == 0 && index >= (strip_.getLength() - 1) / kE131PixelsPerUniverse) {
+    commit();
+  }
+  return written;
+}
+
+bool LedStreamReceiver::acceptDdpSequence(uint8_t sequence, uint32_t now) {
+  // Sequence numbers run 1-15; 0 means the sender does not number packets
+  if (sequence != 0 && ddpSequence_ != 0 && now - lastPacketTime_ <= kSequenceResetMs) {
+    uint8_t ahead = (sequence + 15 - ddpSequence_) % 15;
+    if (ahead == 0 || ahead > 7) {
+      stats_.late++;
+      return false;
+    }
+    stats_.lost += ahead - 1;
+  }
+  ddpSequence_ = sequence;
+  return true;
+}
+
+bool LedStreamReceiver::acceptE131Sequence(uint8_t index, uint8_t sequence, uint32_t now) {
+  // E1.31 6.7.2: reject when the sequence is up to 20 behind the last one
+  uint32_t bit = 1UL << index;
+  if ((e131SequenceValid_ & bit) != 0 && now - lastPacketTime_ <= kSequenceResetMs) {
+    int8_t ahead = static_cast<int8_t>(sequence - e131Sequence_[index]);
+    if (ahead <= 0 && ahead > -20) {
+      stats_.late++;
+      return false;
+    }
+    if (ahead > 1) {
+      stats_.lost += ahead - 1;
+    }
+  }
+  e131Sequence_[index] = sequence;
+  e131SequenceValid_ |= bit;
+  return true;
+}
+
+bool LedStreamReceiver::writePixels(uint32_t first, const uint8_t* data, uint32_t count, uint8_t stride) {
+  LedColor* out = strip_.streamBuffer();
+  uint16_t length = strip_.getLength();
+  if (out == nullptr || first >= length || count == 0) {
+    return false;
+  }
+  uint16_t end = min<uint32_t>(first + count, length);
+  if (stride == 4) {
+    // RGBW senders: white is added to each channel
+    for (uint16_t i = first; i < end; i++, data += 4) {
+      out[i] = LedColor(min(data[0] + data[3], 255) << 8, min(data[1] + data[3], 255) << 8,
+                        min(data[2] + data[3], 255) << 8);
+    }
+  } else {
+    for (uint16_t i = first; i < end; i++, data += 3) {
+      out[i] = LedColor(data[0] << 8, data[1] << 8, data[2] << 8);
+    }
+  }
+  frameEnd_ = max(frameEnd_, end);
+  framePending_ = true;
+  return true;
+}
+
+void LedStreamReceiver::commit() {
+  LedColor* out = strip_.streamBuffer();
+  if (!framePending_ || out == nullptr) {
+    return;
+  }
+  // Pixels the sender does not cover go dark rather than show an older frame
+  for (uint16_t i = frameEnd_; i < strip_.getLength(); i++) {
+    out[i] = LedColor();
+  }
+  strip_.commitStream();
+  stats_.frames++;
+  frameEnd_ = 0;
+  framePending_ = false;
+  syncUniverse_ = 0;
+}
+
+}  // namespace espmods::led
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "LedStrip.h"
+
+namespace espmods::led {
+
+/**
+ * @brief Decoder for DDP and E1.31 (sACN) pixel packets into a LedStrip
+ *
+ * Transport independent: hand it every UDP payload, e.g. from
+ * network::NetPixelReceiver or a socket on the host. RGB data is
+ * converted straight from the packet into the strip's stream buffer
+ * (LedStrip::beginStream()), which the renderer then shows without
+ * another copy, so a packet is touched once.
+ *
+ * Frame sync:
+ * - DDP: the frame is shown at the packet with the push flag.
+ * - E1.31: with a synchronization universe the frame is shown at the
+ *   matching sync packet; otherwise at the universe holding the strip's
+ *   last pixel, or when a sender that covers fewer pixels starts its
+ *   next frame.
+ *
+ * Packets arriving late (by their sequence number) are dropped so a
+ * reordered packet never overwrites newer pixels. Every frame should
+ * cover all the pixels it wants lit: pixels past the last one written go
+ * dark, and a lost packet leaves an older frame's pixels in its range.
+ *
+ * The handlers may run on another task than begin() and end() (the
+ * AsyncUDP task in NetPixelReceiver), but never at the same time as
+ * begin(), end() or setUniverse(): start feeding packets after begin()
+ * returns, stop before end(), and set the universe while stopped.
+ */
+class LedStreamReceiver {
+ public:
+  static constexpr uint16_t kDdpPort = 4048;
+  static constexpr uint16_t kE131Port = 5568;
+  static constexpr uint16_t kE131PixelsPerUniverse = 170;  // 510 of 512 DMX channels
+  static constexpr uint8_t kMaxUniverses = 32;
+
+  /**
+   * @brief Packet counters since begin()
+   */
+  struct Stats {
+    uint32_t packets = 0;     // Data packets written to the strip
+    uint32_t frames = 0;      // Frames committed
+    uint32_t late = 0;        // Late or duplicate packets dropped
+    uint32_t lost = 0;        // Packets missing from sequence gaps
+    uint32_t ignored = 0;     // Malformed, preview, other outputs or universes
+  };
+
+  /**
+   * @param strip Strip to drive; must outlive the receiver
+   */
+  explicit LedStreamReceiver(LedStrip& strip);
+
+  /**
+   * @brief Take over the strip (LedStrip::beginStream())
+   *
+   * Packets are dropped until the strip's renderer accepted the stream,
+   * usually within one frame.
+   * @param timeoutMs Time without a frame before the strip's effects return
+   * @return false if the stream buffers could not be allocated
+   */
+  bool begin(uint16_t timeoutMs = 2500);
+
+  /**
+   * @brief Return the strip to its effects; stop feeding packets first
+   */
+  void end();
+
+  /**
+   * @brief First E1.31 universe; the strip spans consecutive universes
+   *
+   * Not synchronised with the handlers; call while no packets are fed.
+   * @param universe Universe of pixel 0 (1-63999)
+   */
+  void setUniverse(uint16_t universe) { firstUniverse_ = universe; }
+
+  /**
+   * @brief Decode one DDP packet
+   * @param data UDP payload
+   * @param length Payload length
+   * @param now Current time in ms, used to resynchronise after a pause
+   * @return true if pixels were written
+   */
+  bool handleDdp(const uint8_t* data, size_t length, uint32_t now);
+
+  /**
+   * @brief Decode one E1.31 data or synchronization packet
+   * @param data UDP payload
+   * @param length Payload length
+   * @param now Current time in ms, used to resynchronise after a pause
+   * @return true if pixels were written or a frame was committed
+   */
+  bool handleE131(const uint8_t* data, size_t length, uint32_t now);
+
+  const Stats& getStats() const { return stats_; }
+
+ private:
+  // A sender silent this long may restart its sequence numbers anywhere
+  static constexpr uint32_t kSequenceResetMs = 1000;
+
+  bool acceptDdpSequence(uint8_t sequence, uint32_t now);
+  bool acceptE131Sequence(uint8_t index, uint8_t sequence, uint32_t now);
+  bool writePixels(uint32_t first, const uint8_t* data, uint32_t count, uint8_t stride);
+  void commit();
+
+  LedStrip& strip_;
+  Stats stats_;
+  uint16_t firstUniverse_;
+  uint32_t lastPacketTime_;
+  uint8_t ddpSequence_;                     // Last DDP sequence (1-15), 0 for none
+  uint8_t e131Sequence_[kMaxUniverses];     // Last sequence per universe
+  uint32_t e131SequenceValid_;              // Bit per universe with a sequence
+  uint8_t lastUniverse_;                    // Universe index of the previous E1.31 packet
+  uint16_t syncUniverse_;                   // Sync universe the pending frame waits for, 0 for none
+  uint16_t frameEnd_;                       // One past the highest pixel written this frame
+  bool framePending_;                       // Pixels written since the last commit
+};
+
+}  // namespace espmods::led
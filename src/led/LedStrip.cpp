@@ -1,87 +1,851 @@
 #include "LedStrip.h"
-#include <cmath>
+#include "LedMath.h"
+
+#include <new>
 
 namespace espmods::led {
 
+namespace {
+
+// Q8.8 strip level to the output's channel range
+inline uint16_t widen(uint16_t level) {
+  return level + (level >> 8);
+}
+
+inline uint16_t roundLevel(uint16_t level) {
+  return (level + 0x80) >> 8;
+}
+
+inline uint16_t ditherLevel(uint16_t level, uint8_t threshold) {
+  return (level >> 8) + ((level & 0xFF) > threshold);
+}
+
+// Timeline layouts carry their own revisions, distinct from setEffect()'s
+constexpr uint32_t kTimelineRevision = 0x80000000;
+
+// Stream mailbox: buffer pointer with bit 0 set while the frame is unread
+constexpr uintptr_t kStreamFresh = 1;
+
+inline LedColor* mailboxBuffer(uintptr_t mail) {
+  return reinterpret_cast<LedColor*>(mail & ~kStreamFresh);
+}
+
+// Segments must not share pixels: each would paint them in table order
+bool overlapsAny(const LedSegment* segments, uint8_t count, const LedSegment& segment) {
+  for (uint8_t s = 0; s < count; s++) {
+    if (segment.start < segments[s].start + segments[s].length &&
+        segments[s].start < segment.start + segment.length) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 LedStrip::LedStrip(uint8_t pin, uint16_t count, uint8_t brightness)
-    : strip_(count, pin),
+    : LedStrip(*new NeoPixelOutput<NeoGrbFeature, NeoEsp32I2s0800KbpsMethod>(count, pin), count,
+               brightness, nullptr) {
+  ownsOutput_ = true;
+}
+
+LedStrip::LedStrip(LedOutput& output, uint16_t count, uint8_t brightness, LedPixelPool& pool)
+    : LedStrip(output, count, brightness, pool.take(2 * count)) {
+  // Without room the frames came from the heap (see the buffers
+  // constructor) and the transition buffers are allocated on first use
+  LedColor* scratch = pool.take(2 * count);
+  if (scratch != nullptr) {
+    scratch_[0] = scratch;
+    scratch_[1] = scratch + count;
+  }
+}
+
+LedStrip::LedStrip(LedOutput& output, uint16_t count, uint8_t brightness, LedColor* frames,
+                   LedColor* scratch)
+    : output_(&output),
+      ownsOutput_(false),
+      ownsFrames_(frames == nullptr),
+      ownsScratch_(false),
+      frameStorage_(frames != nullptr ? frames : new LedColor[2 * count]),
       count_(count),
       brightness_(brightness),
-      effectStartTime_(0),
+      requestedBrightness_(brightness),
+      gammaEnabled_(true),
+      ditherEnabled_(false),
+      requestedGamma_(true),
+      requestedDither_(false),
+      outputDirty_(true),
+      ditherPending_(false),
+      ditherFrame_(0),
+      pendingTableSeq_(0),
+      appliedTableSeq_(0),
+      nextRevision_(0),
+      segmentCount_(0),
       lastUpdate_(0),
-      wavePosition_(0.0f),
-      lastFlickerUpdate_(0),
-      lightningStartTime_(0),
-      lightningActive_(false),
-      lastSparkleUpdate_(0),
-      sparklePixels_(nullptr) {
-  
-  // Allocate sparkle tracking array
-  sparklePixels_ = new uint8_t[count_];
-  memset(sparklePixels_, 0, count_);
+      random_(random(1, 0x7FFFFFFF)),
+      stateBlocks_{},
+      stateCapacity_{},
+      scratch_{scratch, scratch != nullptr ? scratch + count : nullptr},
+      transitionType_(LedTransition::Cut),
+      transitionMs_(0),
+      frames_{frameStorage_, frameStorage_ + count},
+      back_(nullptr),
+      target_(nullptr),
+      frontIndex_(0),
+      renderTask_(nullptr),
+      controlled_(false),
+      wakeTask_(nullptr),
+      frameIntervalMs_(1000 / kDefaultTargetFps),
+      lastFrameTime_(0),
+      requestedTimeline_(nullptr),
+      timelineRequestSeq_(0),
+      appliedTimelineSeq_(0),
+      timeline_(nullptr),
+      timelineRevision_(0),
+      timelineFrameMode_(false),
+      audioChannel_(nullptr),
+      audioShowPending_(false),
+      streamStorage_(nullptr),
+      streamRequested_(false),
+      streamRequestSeq_(0),
+      streamTimeoutMs_(0),
+      streamActive_(false),
+      streamMailbox_(0),
+      streamFramesDropped_(0),
+      streamInput_(nullptr),
+      streamSpare_{},
+      appliedStreamSeq_(0),
+      streamFrameTime_(0),
+      streamLent_(false),
+      streamShowing_(false),
+      streamFrameNew_(false),
+      renderMicros_(0),
+      framesShown_(0),
+      framesSkipped_(0),
+      audioLatencyMicros_(0),
+      maxAudioLatencyMicros_(0) {
+  clearFrames();
+  back_ = frames_[1];
+  buildOutputTable();
 }
 
 LedStrip::~LedStrip() {
-  delete[] sparklePixels_;
+  if (renderTask_ != nullptr) {
+    if (audioChannel_ != nullptr) {
+      audioChannel_->setConsumerTask(nullptr);
+    }
+    vTaskDelete(renderTask_);
+  }
+  for (uint8_t b = 0; b < 2; b++) {
+    for (uint8_t s = 0; s < kMaxSegments; s++) {
+      delete[] stateBlocks_[s][b];
+    }
+  }
+  delete[] streamStorage_;
+  if (ownsScratch_) {
+    delete[] scratch_[0];
+    delete[] scratch_[1];
+  }
+  if (ownsFrames_) {
+    delete[] frameStorage_;
+  }
+  if (ownsOutput_) {
+    delete output_;
+  }
 }
 
 void LedStrip::begin() {
-  strip_.Begin();
-  off();
-  effectStartTime_ = millis();
+  output_->begin();
+  // Keep a layout configured before begin()
+  if (controlTable_.count == 0) {
+    off();
+  }
 }
 
 void LedStrip::update() {
+  // The render task or a controller owns the frame loop once started
+  if (renderTask_ != nullptr || controlled_) {
+    return;
+  }
   uint32_t now = millis();
+  uint32_t interval = frameIntervalMs_.load(std::memory_order_relaxed);
+  if (interval > 0 && now - lastFrameTime_ < interval && !inputPending()) {
+    return;
+  }
+  lastFrameTime_ = now;
+  renderFrame(now);
+}
+
+bool LedStrip::startRenderTask(int8_t core, uint8_t priority) {
+  if (renderTask_ != nullptr) {
+    return true;
+  }
+  if (controlled_) {
+    return false;
+  }
+  if (core < 0) {
+    // Default to the core the caller (usually the Arduino loop) is not on
+    core = xPortGetCoreID() == 0 ? 1 : 0;
+  }
+  BaseType_t created = xTaskCreatePinnedToCore(renderTaskEntry, "LedStrip", kRenderTaskStackSize,
+                                               this, priority, &renderTask_, core);
+  if (created != pdPASS) {
+    renderTask_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void LedStrip::renderTaskEntry(void* arg) {
+  LedStrip* self = static_cast<LedStrip*>(arg);
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  self->wakeTask_.store(task, std::memory_order_release);
+  if (self->audioChannel_ != nullptr) {
+    self->audioChannel_->setConsumerTask(task);
+  }
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    self->renderFrame(millis());
+    TickType_t ticks = pdMS_TO_TICKS(self->frameIntervalMs_.load(std::memory_order_relaxed));
+    if (ticks == 0) {
+      ticks = 1;
+    }
+    // Sleep until the next frame slot, a new mic frame or a stream frame,
+    // whichever is first
+    TickType_t elapsed = xTaskGetTickCount() - lastWake;
+    ulTaskNotifyTake(pdTRUE, elapsed < ticks ? ticks - elapsed : 0);
+    lastWake = xTaskGetTickCount();
+  }
+}
+
+void LedStrip::renderFrame(uint32_t now) {
+  if (composeFrame(now)) {
+    pushFrame();
+  } else {
+    framesSkipped_++;
+  }
+}
+
+void LedStrip::pushFrame() {
+  output_->show();
+  framesShown_++;
+  if (audioShowPending_) {
+    audioShowPending_ = false;
+    audioLatencyMicros_ = micros() - audio_.result.captureMicros;
+    maxAudioLatencyMicros_ = max(maxAudioLatencyMicros_, audioLatencyMicros_);
+  }
+}
+
+void LedStrip::pollAudio() {
+  audio_.fresh = audioChannel_ != nullptr && audioChannel_->popLatest(audio_.result);
+  audio_.valid |= audio_.fresh;
+}
+
+bool LedStrip::inputPending() const {
+  return (audioChannel_ != nullptr && audioChannel_->available()) ||
+         (streamMailbox_.load(std::memory_order_relaxed) & kStreamFresh) != 0;
+}
+
+bool LedStrip::composeFrame(uint32_t now) {
+  applyPendingControls(now);
+  pollAudio();
+  if (streamLent_ && updateStream(now)) {
+    // Stream frames are published as they arrive; effects are paused
+    if (!streamFrameNew_ && !outputDirty_ && !ditherPending_) {
+      audioShowPending_ = false;
+      return false;
+    }
+    streamFrameNew_ = false;
+    renderMicros_ = 0;
+    writeOutput(frames_[frontIndex_.load(std::memory_order_relaxed)]);
+    audioShowPending_ = audio_.fresh;
+    return true;
+  }
+  if (timeline_ != nullptr) {
+    advanceTimeline(now);
+  }
   lastUpdate_ = now;
+  uint8_t backIndex = frontIndex_.load(std::memory_order_relaxed) ^ 1;
+  back_ = frames_[backIndex];
   
-  switch (currentEffect_.effect) {
-    case LedEffect::Off:
-      renderOff();
-      break;
-    case LedEffect::SolidColor:
-      renderSolidColor();
-      break;
-    case LedEffect::Pulse:
-      renderPulse();
+  uint32_t renderStart = micros();
+  bool segmentChanged[kMaxSegments];
+  bool changed = false;
+  for (uint8_t s = 0; s < segmentCount_; s++) {
+    if (transitions_[s].active) {
+      renderTransition(s);
+      segmentChanged[s] = true;
+    } else {
+      target_ = back_;
+      segmentChanged[s] = renderSegment(segments_[s]);
+      segments_[s].dirty = false;
+    }
+    changed |= segmentChanged[s];
+  }
+  
+  // Timeline pixel frames overwrite the whole back buffer
+  const LedColor* front = frames_[backIndex ^ 1];
+  bool frameDecoded = timelineFrameMode_ && decodeTimelineFrames(now, front);
+  changed |= frameDecoded;
+  
+  // Unchanged frames never reach the I2S DMA, unless the output stage
+  // changed or is still dithering between levels
+  if (!changed && !outputDirty_ && !ditherPending_) {
+    renderMicros_ = micros() - renderStart;
+    audioShowPending_ = false;
+    return false;
+  }
+  
+  if (changed) {
+    // The back buffer is two frames old; carry idle segments over from the front
+    for (uint8_t s = 0; s < segmentCount_ && !frameDecoded; s++) {
+      if (!segmentChanged[s]) {
+        const LedSegment& segment = segments_[s].segment;
+        memcpy(back_ + segment.start, front + segment.start, segment.length * sizeof(LedColor));
+      }
+    }
+    // Publish the completed back buffer
+    frontIndex_.store(backIndex, std::memory_order_release);
+  }
+  renderMicros_ = micros() - renderStart;
+  
+  writeOutput(frames_[frontIndex_.load(std::memory_order_relaxed)]);
+  audioShowPending_ = audio_.fresh;
+  return true;
+}
+
+bool LedStrip::renderSegment(SegmentState& seg) {
+  LedEffectContext context(seg.segment, seg.clock, seg.dirty, lastUpdate_, random_, audio_,
+                           target_);
+  return seg.type->render(context, seg.state);
+}
+
+void LedStrip::renderTransition(uint8_t slot) {
+  SegmentState& seg = segments_[slot];
+  TransitionState& transition = transitions_[slot];
+  uint32_t elapsed = lastUpdate_ - transition.startTime;
+  if (elapsed >= transitionMs_) {
+    // Done: the new effect repaints straight into the frame again
+    transition.active = false;
+    seg.dirty = true;
+    target_ = back_;
+    renderSegment(seg);
+    seg.dirty = false;
+    return;
+  }
+  
+  // Both effects keep their own persistent scratch output, so throttled
+  // or static effects that skip a frame still blend correctly
+  target_ = scratch_[0];
+  renderSegment(transition.outgoing);
+  transition.outgoing.dirty = false;
+  target_ = scratch_[1];
+  renderSegment(seg);
+  seg.dirty = false;
+  blendTransition(seg, transition, (static_cast<uint32_t>(elapsed) << 16) / transitionMs_);
+}
+
+void LedStrip::blendTransition(const SegmentState& seg, const TransitionState& transition,
+                               uint16_t progress) {
+  const LedSegment& segment = seg.segment;
+  const LedColor* from = scratch_[0] + segment.start;
+  const LedColor* to = scratch_[1] + segment.start;
+  LedColor* out = back_ + segment.start;
+  uint8_t amount = progress >> 8;
+  
+  switch (transitionType_) {
+    case LedTransition::Crossfade:
+      for (uint16_t i = 0; i < segment.length; i++) {
+        out[i] = blendColor(from[i], to[i], amount);
+      }
       break;
-    case LedEffect::GradientPulse:
-      renderGradientPulse();
+    case LedTransition::Wipe: {
+      // Q16 edge position along the segment direction, one-pixel soft edge
+      uint32_t edge = static_cast<uint32_t>(progress) * segment.length;
+      for (uint16_t i = 0; i < segment.length; i++) {
+        uint16_t p = segment.effect.reverse ? segment.length - 1 - i : i;
+        uint32_t pixelStart = static_cast<uint32_t>(i) << 16;
+        uint8_t mix = 0;
+        if (edge >= pixelStart + 0x10000) {
+          mix = 255;
+        } else if (edge > pixelStart) {
+          mix = (edge - pixelStart) >> 8;
+        }
+        out[p] = blendColor(from[p], to[p], mix);
+      }
       break;
-    case LedEffect::RandomFlicker:
-      renderRandomFlicker();
+    }
+    case LedTransition::Dissolve:
+      // 167 is odd, so i * 167 + seed visits every 8-bit threshold once per 256 pixels
+      for (uint16_t i = 0; i < segment.length; i++) {
+        uint8_t threshold = static_cast<uint8_t>(i * 167 + transition.seed);
+        out[i] = amount > threshold ? to[i] : from[i];
+      }
       break;
-    case LedEffect::Strobe:
-      renderStrobe();
+    case LedTransition::Cut:
+      memcpy(out, to, segment.length * sizeof(LedColor));
       break;
-    case LedEffect::ColorWave:
-      renderColorWave();
+  }
+}
+
+void LedStrip::applyPendingControls(uint32_t now) {
+  uint32_t streamSeq = streamRequestSeq_.load(std::memory_order_acquire);
+  if (streamSeq != appliedStreamSeq_) {
+    appliedStreamSeq_ = streamSeq;
+    bool requested = streamRequested_.load(std::memory_order_relaxed);
+    if (requested && !streamLent_) {
+      startStream();
+    } else if (!requested && streamLent_) {
+      stopStream();
+    } else if (requested) {
+      // endStream() and beginStream() between two frames
+      streamActive_.store(true, std::memory_order_release);
+    }
+  }
+  
+  uint32_t timelineSeq = timelineRequestSeq_.load(std::memory_order_acquire);
+  if (timelineSeq != appliedTimelineSeq_) {
+    appliedTimelineSeq_ = timelineSeq;
+    LedTimeline* timeline = requestedTimeline_.load(std::memory_order_acquire);
+    if (timeline != nullptr) {
+      startTimeline(timeline, now);
+    } else if (timeline_ != nullptr) {
+      endTimeline();
+    }
+  }
+  
+  // Seqlock read: retry next frame if the writer is mid-update. The
+  // control layout waits while a timeline plays.
+  uint32_t seq = pendingTableSeq_.load(std::memory_order_acquire);
+  if (timeline_ == nullptr && seq != appliedTableSeq_ && (seq & 1) == 0) {
+    SegmentTable table = pendingTable_;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (pendingTableSeq_.load(std::memory_order_relaxed) == seq) {
+      appliedTableSeq_ = seq;
+      applySegmentTable(table, now);
+    }
+  }
+  
+  // Output settings only rebuild the table; effects are not repainted
+  uint8_t brightness = requestedBrightness_.load(std::memory_order_relaxed);
+  bool gamma = requestedGamma_.load(std::memory_order_relaxed);
+  bool dither = requestedDither_.load(std::memory_order_relaxed);
+  if (brightness != brightness_ || gamma != gammaEnabled_ || dither != ditherEnabled_) {
+    brightness_ = brightness;
+    gammaEnabled_ = gamma;
+    ditherEnabled_ = dither;
+    buildOutputTable();
+  }
+}
+
+void LedStrip::applySegmentTable(const SegmentTable& table, uint32_t now) {
+  bool layoutChanged = table.count != segmentCount_;
+  for (uint8_t s = 0; s < table.count && !layoutChanged; s++) {
+    const LedSegment& next = table.segments[s];
+    const LedSegment& current = segments_[s].segment;
+    layoutChanged = next.start != current.start || next.length != current.length;
+  }
+  if (layoutChanged) {
+    // Pixels no longer covered by a segment must go dark in both buffers
+    clearFrames();
+  }
+  
+  transitionType_ = table.transition;
+  transitionMs_ = table.transitionMs;
+  bool animate = !layoutChanged && transitionType_ != LedTransition::Cut && transitionMs_ > 0;
+  
+  segmentCount_ = table.count;
+  for (uint8_t s = 0; s < segmentCount_; s++) {
+    SegmentState& seg = segments_[s];
+    TransitionState& transition = transitions_[s];
+    if (!layoutChanged && seg.revision == table.revisions[s]) {
+      continue;
+    }
+    if (animate) {
+      // A change mid-transition restarts from the effect currently shown
+      transition.outgoing = seg;
+      transition.outgoing.dirty = true;
+      transition.startTime = now;
+      transition.seed = random_.next8();
+      transition.active = true;
+      seg.bank ^= 1;
+    } else {
+      transition.active = false;
+    }
+    seg.segment = table.segments[s];
+    seg.revision = table.revisions[s];
+    resetSegment(seg, s, now);
+  }
+}
+
+void LedStrip::startTimeline(LedTimeline* timeline, uint32_t now) {
+  timeline_ = timeline;
+  timelineFrameMode_ = false;
+  // The current effects keep running until the first layout record
+  timelineTable_ = SegmentTable();
+  timelineTable_.transition = transitionType_;
+  timelineTable_.transitionMs = transitionMs_;
+  if (!timeline->start(now)) {
+    endTimeline();
+  }
+}
+
+void LedStrip::endTimeline() {
+  timeline_ = nullptr;
+  timelineFrameMode_ = false;
+  // Odd, so the control table is applied again
+  appliedTableSeq_ = 1;
+}
+
+void LedStrip::advanceTimeline(uint32_t now) {
+  LedTimeline::Op op;
+  while (timeline_ != nullptr && timeline_->poll(now, op)) {
+    if (op == LedTimeline::Op::Frame) {
+      // Decoded once the segments rendered; the layout is cleared first so
+      // no effect paints over the frame
+      if (!timelineFrameMode_) {
+        LedTransition transition = timelineTable_.transition;
+        timelineTable_.count = 1;
+        timelineTable_.segments[0] = LedSegment();
+        timelineTable_.segments[0].length = count_;
+        timelineTable_.revisions[0] = kTimelineRevision | ++timelineRevision_;
+        timelineTable_.transition = LedTransition::Cut;
+        applySegmentTable(timelineTable_, now);
+        timelineTable_.transition = transition;
+        timelineFrameMode_ = true;
+      }
+      return;
+    }
+    LedTimeline::Event event;
+    if (!timeline_->readEvent(event)) {
+      timeline_->finish();
       break;
-    case LedEffect::Fire:
-      renderFire();
+    }
+    applyTimelineEvent(event, now);
+  }
+  if (timeline_ != nullptr && timeline_->isFinished()) {
+    endTimeline();
+  }
+}
+
+bool LedStrip::decodeTimelineFrames(uint32_t now, const LedColor* front) {
+  // Frames that are already late decode on top of each other, so a slow
+  // frame does not make the show fall behind
+  bool decoded = false;
+  const LedColor* base = front;
+  LedTimeline::Op op;
+  while (timeline_ != nullptr && timeline_->poll(now, op) && op == LedTimeline::Op::Frame) {
+    if (!timeline_->decodeFrame(back_, base, count_)) {
+      timeline_->finish();
+      decoded = false;
       break;
-    case LedEffect::Lightning:
-      renderLightning();
+    }
+    decoded = true;
+    base = back_;
+  }
+  if (timeline_ != nullptr && timeline_->isFinished()) {
+    endTimeline();
+  }
+  return decoded;
+}
+
+void LedStrip::applyTimelineEvent(const LedTimeline::Event& event, uint32_t now) {
+  SegmentTable& table = timelineTable_;
+  uint32_t revision = kTimelineRevision | ++timelineRevision_;
+  LedTransition transition = table.transition;
+  uint16_t transitionMs = table.transitionMs;
+  
+  switch (event.op) {
+    case LedTimeline::Op::Effect:
+      if (event.segment == LedTimeline::kWholeStrip) {
+        table.count = 1;
+        table.segments[0] = LedSegment();
+        table.segments[0].length = count_;
+        table.segments[0].effect = event.config;
+        table.revisions[0] = revision;
+      } else if (event.segment < table.count && !timelineFrameMode_) {
+        table.segments[event.segment].effect = event.config;
+        table.revisions[event.segment] = revision;
+      } else {
+        return;
+      }
       break;
-    case LedEffect::Rainbow:
-      renderRainbow();
+    case LedTimeline::Op::Layout:
+      // Invalid and overlapping ranges are dropped like addSegment()
+      // rejects them
+      table.count = 0;
+      for (uint8_t s = 0; s < event.segmentCount && table.count < kMaxSegments; s++) {
+        const LedSegment& segment = event.segments[s];
+        if (segment.length == 0 || segment.start >= count_ || segment.length > count_ - segment.start ||
+            overlapsAny(table.segments, table.count, segment)) {
+          continue;
+        }
+        table.segments[table.count] = segment;
+        table.revisions[table.count++] = revision;
+      }
       break;
-    case LedEffect::Sparkle:
-      renderSparkle();
+    case LedTimeline::Op::Transition:
+      if (event.value <= static_cast<uint8_t>(LedTransition::Dissolve)) {
+        table.transition = static_cast<LedTransition>(event.value);
+        table.transitionMs = min<uint32_t>(event.durationMs, 0xFFFF);
+      }
+      return;
+    case LedTimeline::Op::Color:
+      // Keyframe: crossfade the whole strip to the colour over the fade time
+      table.count = 1;
+      table.segments[0] = LedSegment();
+      table.segments[0].length = count_;
+      table.segments[0].effect = event.config;
+      table.revisions[0] = revision;
+      table.transition = event.durationMs > 0 ? LedTransition::Crossfade : LedTransition::Cut;
+      table.transitionMs = min<uint32_t>(event.durationMs, 0xFFFF);
       break;
+    case LedTimeline::Op::Brightness:
+      requestedBrightness_.store(event.value, std::memory_order_relaxed);
+      return;
+    default:
+      return;
   }
   
-  strip_.Show();
+  timelineFrameMode_ = false;
+  applySegmentTable(timelineTable_, now);
+  table.transition = transition;
+  table.transitionMs = transitionMs;
 }
 
-void LedStrip::setEffect(const LedEffectConfig& config) {
-  currentEffect_ = config;
-  effectStartTime_ = millis();
+void LedStrip::startStream() {
+  if (streamSpare_[0] == nullptr) {
+    streamSpare_[0] = streamStorage_;
+    streamSpare_[1] = streamStorage_ + count_;
+  }
+  streamMailbox_.store(reinterpret_cast<uintptr_t>(streamSpare_[0]), std::memory_order_relaxed);
+  streamInput_ = streamSpare_[1];
+  streamLent_ = true;
+  streamShowing_ = false;
+  streamFrameNew_ = false;
+  streamActive_.store(true, std::memory_order_release);
+}
+
+void LedStrip::stopStream() {
+  // The producer has stopped, so streamInput_ is ours again
+  streamSpare_[0] = mailboxBuffer(streamMailbox_.exchange(0, std::memory_order_acquire));
+  streamSpare_[1] = streamInput_;
+  streamInput_ = nullptr;
+  streamLent_ = false;
+  if (streamShowing_) {
+    resumeEffects();
+  }
+}
+
+bool LedStrip::updateStream(uint32_t now) {
+  if (streamMailbox_.load(std::memory_order_acquire) & kStreamFresh) {
+    // Trade the back buffer for the new frame; the producer gets it as its
+    // next input at the following commitStream()
+    uint8_t backIndex = frontIndex_.load(std::memory_order_relaxed) ^ 1;
+    uintptr_t mail = streamMailbox_.exchange(reinterpret_cast<uintptr_t>(frames_[backIndex]),
+                                             std::memory_order_acq_rel);
+    frames_[backIndex] = mailboxBuffer(mail);
+    frontIndex_.store(backIndex, std::memory_order_release);
+    streamFrameTime_ = now;
+    streamShowing_ = true;
+    streamFrameNew_ = true;
+    return true;
+  }
+  if (streamShowing_ && now - streamFrameTime_ >= streamTimeoutMs_.load(std::memory_order_relaxed)) {
+    resumeEffects();
+  }
+  return streamShowing_;
+}
+
+void LedStrip::resumeEffects() {
+  // Effects repaint from a blank frame; pixels outside the segments go dark
+  streamShowing_ = false;
+  streamFrameNew_ = false;
+  clearFrames();
+  for (uint8_t s = 0; s < segmentCount_; s++) {
+    segments_[s].dirty = true;
+    transitions_[s].outgoing.dirty = true;
+  }
+  outputDirty_ = true;
+}
+
+void LedStrip::resetSegment(SegmentState& seg, uint8_t slot, uint32_t now) {
+  // The frame's time, not a fresh millis(): effects measure elapsed time
+  // against the same now they render with, which must not be earlier
+  seg.clock = LedEffectClock();
+  seg.clock.startTime = now;
+  seg.dirty = true;
+  seg.type = LedEffectRegistry::find(seg.segment.effect.effect);
+  if (seg.type == nullptr) {
+    seg.type = LedEffectRegistry::find(LedEffect::Off);
+  }
   
-  // Reset effect-specific state
-  wavePosition_ = 0.0f;
-  lightningActive_ = false;
-  memset(sparklePixels_, 0, count_);
+  size_t size = seg.type->stateSize != nullptr ? seg.type->stateSize(seg.segment.length) : 0;
+  seg.state = size > 0 ? effectState(slot, seg.bank, size) : nullptr;
+  if (size > 0 && seg.state == nullptr) {
+    // Out of memory: keep the segment dark rather than render without state
+    seg.type = LedEffectRegistry::find(LedEffect::Off);
+    return;
+  }
+  if (seg.type->begin != nullptr) {
+    LedEffectContext context(seg.segment, seg.clock, true, now, random_, audio_, back_);
+    seg.type->begin(context, seg.state);
+  }
+}
+
+void* LedStrip::effectState(uint8_t slot, uint8_t bank, size_t size) {
+  if (stateCapacity_[slot][bank] < size) {
+    delete[] stateBlocks_[slot][bank];
+    stateBlocks_[slot][bank] = new (std::nothrow) uint8_t[size];
+    stateCapacity_[slot][bank] = stateBlocks_[slot][bank] != nullptr ? size : 0;
+    if (stateBlocks_[slot][bank] == nullptr) {
+      return nullptr;
+    }
+  }
+  memset(stateBlocks_[slot][bank], 0, size);
+  return stateBlocks_[slot][bank];
+}
+
+RgbColor LedStrip::getPixelColor(uint16_t index) const {
+  if (index >= count_) {
+    return RgbColor(0, 0, 0);
+  }
+  return frames_[frontIndex_.load(std::memory_order_acquire)][index].toRgb();
+}
+
+void LedStrip::setEffect(const LedEffectConfig& config) {
+  controlTable_.count = 1;
+  controlTable_.wholeStrip = true;
+  controlTable_.segments[0] = LedSegment();
+  controlTable_.segments[0].length = count_;
+  controlTable_.segments[0].effect = config;
+  controlTable_.revisions[0] = ++nextRevision_;
+  publishSegmentTable();
+}
+
+int8_t LedStrip::addSegment(const LedSegment& segment) {
+  if (segment.length == 0 || segment.start >= count_ || segment.length > count_ - segment.start) {
+    return -1;
+  }
+  // The whole-strip segment is replaced, so only real segments can clash
+  uint8_t count = controlTable_.wholeStrip ? 0 : controlTable_.count;
+  if (count >= kMaxSegments || overlapsAny(controlTable_.segments, count, segment)) {
+    return -1;
+  }
+  if (controlTable_.wholeStrip) {
+    controlTable_.count = 0;
+    controlTable_.wholeStrip = false;
+  }
+  uint8_t index = controlTable_.count++;
+  controlTable_.segments[index] = segment;
+  controlTable_.revisions[index] = ++nextRevision_;
+  publishSegmentTable();
+  return index;
+}
+
+bool LedStrip::setSegmentEffect(uint8_t index, const LedEffectConfig& config) {
+  if (index >= controlTable_.count) {
+    return false;
+  }
+  controlTable_.segments[index].effect = config;
+  controlTable_.revisions[index] = ++nextRevision_;
+  publishSegmentTable();
+  return true;
+}
+
+bool LedStrip::setTransition(LedTransition type, uint16_t durationMs) {
+  // Published to the renderer with the next table
+  if (type != LedTransition::Cut && !allocateScratch()) {
+    return false;
+  }
+  controlTable_.transition = type;
+  controlTable_.transitionMs = durationMs;
+  publishSegmentTable();
+  return true;
+}
+
+bool LedStrip::allocateScratch() {
+  if (scratch_[0] != nullptr) {
+    return true;
+  }
+  // One-time allocation, freed with the strip
+  LedColor* from = new (std::nothrow) LedColor[count_];
+  LedColor* to = new (std::nothrow) LedColor[count_];
+  if (from == nullptr || to == nullptr) {
+    delete[] from;
+    delete[] to;
+    return false;
+  }
+  scratch_[0] = from;
+  scratch_[1] = to;
+  ownsScratch_ = true;
+  return true;
+}
+
+bool LedStrip::playTimeline(LedTimeline& timeline) {
+  // Keyframe fades use the transition buffers; published with the request
+  if (!allocateScratch()) {
+    return false;
+  }
+  timeline.finished_.store(false, std::memory_order_relaxed);
+  requestedTimeline_.store(&timeline, std::memory_order_relaxed);
+  timelineRequestSeq_.fetch_add(1, std::memory_order_release);
+  return true;
+}
+
+void LedStrip::stopTimeline() {
+  requestedTimeline_.store(nullptr, std::memory_order_relaxed);
+  timelineRequestSeq_.fetch_add(1, std::memory_order_release);
+}
+
+bool LedStrip::isTimelinePlaying() const {
+  LedTimeline* timeline = requestedTimeline_.load(std::memory_order_acquire);
+  return timeline != nullptr && !timeline->isFinished();
+}
+
+bool LedStrip::beginStream(uint16_t timeoutMs) {
+  if (streamStorage_ == nullptr) {
+    // One-time allocation, freed with the strip
+    streamStorage_ = new (std::nothrow) LedColor[2 * count_];
+    if (streamStorage_ == nullptr) {
+      return false;
+    }
+  }
+  streamTimeoutMs_.store(timeoutMs, std::memory_order_relaxed);
+  streamRequested_.store(true, std::memory_order_relaxed);
+  streamRequestSeq_.fetch_add(1, std::memory_order_release);
+  return true;
+}
+
+void LedStrip::endStream() {
+  streamActive_.store(false, std::memory_order_relaxed);
+  streamRequested_.store(false, std::memory_order_relaxed);
+  streamRequestSeq_.fetch_add(1, std::memory_order_release);
+}
+
+void LedStrip::commitStream() {
+  if (!isStreaming()) {
+    return;
+  }
+  uintptr_t previous = streamMailbox_.exchange(reinterpret_cast<uintptr_t>(streamInput_) | kStreamFresh,
+                                               std::memory_order_acq_rel);
+  if (previous & kStreamFresh) {
+    streamFramesDropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+  streamInput_ = mailboxBuffer(previous);
+  TaskHandle_t task = wakeTask_.load(std::memory_order_acquire);
+  if (task != nullptr) {
+    xTaskNotifyGive(task);
+  }
+}
+
+void LedStrip::publishSegmentTable() {
+  // Seqlock write: odd sequence while the table is being copied
+  uint32_t seq = pendingTableSeq_.load(std::memory_order_relaxed);
+  pendingTableSeq_.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  pendingTable_ = controlTable_;
+  pendingTableSeq_.store(seq + 2, std::memory_order_release);
 }
 
 void LedStrip::setSolidColor(uint32_t color) {
@@ -98,7 +862,31 @@ void LedStrip::off() {
 }
 
 void LedStrip::setBrightness(uint8_t brightness) {
-  brightness_ = brightness;
+  requestedBrightness_.store(brightness, std::memory_order_relaxed);
+}
+
+void LedStrip::setGammaCorrection(bool enabled) {
+  requestedGamma_.store(enabled, std::memory_order_relaxed);
+}
+
+void LedStrip::setDithering(bool enabled) {
+  requestedDither_.store(enabled, std::memory_order_relaxed);
+}
+
+void LedStrip::seedRandom(uint32_t seed) {
+  random_.setSeed(seed);
+}
+
+void LedStrip::setTargetFps(uint8_t fps) {
+  frameIntervalMs_.store(fps > 0 ? 1000 / fps : 0, std::memory_order_relaxed);
+}
+
+void LedStrip::setAudioSource(audio::MicResultChannel* channel) {
+  audioChannel_ = channel;
+  audio_ = LedAudioFrame();
+  audioShowPending_ = false;
+  audioLatencyMicros_ = 0;
+  maxAudioLatencyMicros_ = 0;
 }
 
 // Quick effect methods
@@ -149,8 +937,8 @@ void LedStrip::fire(uint8_t intensity) {
   config.effect = LedEffect::Fire;
   config.primaryColor = 0xFF4400; // Orange-red
   config.secondaryColor = 0xFF0000; // Red
-  config.intensity = intensity;
-  config.speed = 100; // Fast fire updates
+  config.intensity = intensity; // Chance of a new spark per step
+  config.speed = 16; // Simulation step, ~60 steps per second
   setEffect(config);
 }
 
@@ -179,256 +967,119 @@ void LedStrip::sparkle(uint32_t color, uint8_t density) {
   setEffect(config);
 }
 
-// Effect rendering methods
-void LedStrip::renderOff() {
-  for (uint16_t i = 0; i < count_; i++) {
-    strip_.SetPixelColor(i, RgbColor(0, 0, 0));
-  }
-}
-
-void LedStrip::renderSolidColor() {
-  RgbColor color = colorFromHex(currentEffect_.primaryColor);
-  for (uint16_t i = 0; i < count_; i++) {
-    strip_.SetPixelColor(i, color);
-  }
-}
-
-void LedStrip::renderPulse() {
-  float intensity = sineWave(lastUpdate_ - effectStartTime_, currentEffect_.speed);
-  RgbColor baseColor = colorFromHex(currentEffect_.primaryColor);
-  
-  for (uint16_t i = 0; i < count_; i++) {
-    RgbColor pulseColor(
-      applyBrightness(baseColor.R * intensity),
-      applyBrightness(baseColor.G * intensity),
-      applyBrightness(baseColor.B * intensity)
-    );
-    strip_.SetPixelColor(i, pulseColor);
-  }
+void LedStrip::vuMeter(uint32_t lowColor, uint32_t highColor, uint8_t sensitivity) {
+  LedEffectConfig config;
+  config.effect = LedEffect::VuMeter;
+  config.primaryColor = lowColor;
+  config.secondaryColor = highColor;
+  config.intensity = sensitivity; // dB range of the meter
+  config.speed = 1500; // Time for the bar to fall its full length
+  setEffect(config);
 }
 
-void LedStrip::renderGradientPulse() {
-  float phase = sineWave(lastUpdate_ - effectStartTime_, currentEffect_.speed);
-  RgbColor color1 = colorFromHex(currentEffect_.primaryColor);
-  RgbColor color2 = colorFromHex(currentEffect_.secondaryColor);
-  
-  for (uint16_t i = 0; i < count_; i++) {
-    float position = count_ > 1 ? (float)i / (count_ - 1) : 0.0f;
-    RgbColor gradientColor = blendColors(color1, color2, position);
-    
-    RgbColor pulseColor(
-      applyBrightness(gradientColor.R * phase),
-      applyBrightness(gradientColor.G * phase),
-      applyBrightness(gradientColor.B * phase)
-    );
-    strip_.SetPixelColor(i, pulseColor);
-  }
+void LedStrip::beatPulse(uint32_t color, uint32_t speed) {
+  LedEffectConfig config;
+  config.effect = LedEffect::BeatPulse;
+  config.primaryColor = color;
+  config.intensity = 160; // Beat sensitivity
+  config.speed = speed; // Fade time after each beat
+  setEffect(config);
 }
 
-void LedStrip::renderRandomFlicker() {
-  if (lastUpdate_ - lastFlickerUpdate_ >= currentEffect_.speed) {
-    lastFlickerUpdate_ = lastUpdate_;
-    
-    RgbColor baseColor = colorFromHex(currentEffect_.primaryColor);
-    
-    for (uint16_t i = 0; i < count_; i++) {
-      // Random flicker intensity
-      float flicker = 0.5f + (random(0, currentEffect_.intensity) / 255.0f) * 0.5f;
-      
-      RgbColor flickerColor(
-        applyBrightness(baseColor.R * flicker),
-        applyBrightness(baseColor.G * flicker),
-        applyBrightness(baseColor.B * flicker)
-      );
-      strip_.SetPixelColor(i, flickerColor);
+// Output stage
+void LedStrip::buildOutputTable() {
+  if (gammaEnabled_) {
+    // gamma(v * b) == gamma(v) * gamma(b), so brightness keeps its
+    // perceived curve while the product stays at 16 bits
+    const uint16_t* gamma = gammaTable();
+    uint32_t level = gamma[brightness_];
+    for (uint16_t v = 0; v < 256; v++) {
+      outputTable_[v] = gamma[v] * level / 65280;
     }
-  }
-}
-
-void LedStrip::renderStrobe() {
-  uint32_t elapsed = lastUpdate_ - effectStartTime_;
-  uint32_t cycle = elapsed % currentEffect_.speed;
-  bool on = cycle < (currentEffect_.speed / 2);
-  
-  RgbColor color = on ? colorFromHex(currentEffect_.primaryColor) : RgbColor(0, 0, 0);
-  
-  for (uint16_t i = 0; i < count_; i++) {
-    strip_.SetPixelColor(i, color);
-  }
-}
-
-void LedStrip::renderColorWave() {
-  uint32_t elapsed = lastUpdate_ - effectStartTime_;
-  float waveProgress = (float)(elapsed % currentEffect_.speed) / currentEffect_.speed;
-  
-  RgbColor color1 = colorFromHex(currentEffect_.primaryColor);
-  RgbColor color2 = colorFromHex(currentEffect_.secondaryColor);
-  
-  for (uint16_t i = 0; i < count_; i++) {
-    float position = (float)i / count_;
-    float wavePhase = fmod(position + waveProgress, 1.0f);
-    float intensity = sin(wavePhase * TWO_PI) * 0.5f + 0.5f;
-    
-    RgbColor waveColor = blendColors(color1, color2, intensity);
-    strip_.SetPixelColor(i, waveColor);
-  }
-}
-
-void LedStrip::renderFire() {
-  if (lastUpdate_ - lastFlickerUpdate_ >= currentEffect_.speed) {
-    lastFlickerUpdate_ = lastUpdate_;
-    
-    for (uint16_t i = 0; i < count_; i++) {
-      // Create fire effect with random oranges and reds
-      uint8_t red = random(100, 255);
-      uint8_t green = random(0, red / 2);
-      uint8_t blue = 0;
-      
-      // Add some flicker
-      float flicker = 0.7f + (random(0, 30) / 100.0f);
-      
-      RgbColor fireColor(
-        applyBrightness(red * flicker),
-        applyBrightness(green * flicker),
-        applyBrightness(blue)
-      );
-      strip_.SetPixelColor(i, fireColor);
+  } else {
+    for (uint16_t v = 0; v < 256; v++) {
+      outputTable_[v] = (v * brightness_ * 256UL) / 255;
     }
   }
+  outputTable_[256] = outputTable_[255];
+  outputDirty_ = true;
 }
 
-void LedStrip::renderLightning() {
-  uint32_t elapsed = lastUpdate_ - effectStartTime_;
-  
-  // Lightning strikes every few seconds with random timing
-  if (!lightningActive_ && elapsed > 1000 && random(0, 100) < 2) {
-    lightningActive_ = true;
-    lightningStartTime_ = lastUpdate_;
-  }
-  
-  if (lightningActive_) {
-    uint32_t lightningElapsed = lastUpdate_ - lightningStartTime_;
-    
-    if (lightningElapsed < 100) {
-      // Bright flash
-      RgbColor lightningColor = colorFromHex(currentEffect_.primaryColor);
-      for (uint16_t i = 0; i < count_; i++) {
-        strip_.SetPixelColor(i, lightningColor);
-      }
-    } else if (lightningElapsed < 150) {
-      // Brief darkness
-      for (uint16_t i = 0; i < count_; i++) {
-        strip_.SetPixelColor(i, RgbColor(0, 0, 0));
-      }
-    } else if (lightningElapsed < 200) {
-      // Second flash (dimmer)
-      RgbColor lightningColor = colorFromHex(currentEffect_.primaryColor);
-      lightningColor.R /= 2;
-      lightningColor.G /= 2;
-      lightningColor.B /= 2;
-      for (uint16_t i = 0; i < count_; i++) {
-        strip_.SetPixelColor(i, lightningColor);
-      }
-    } else {
-      // End lightning
-      lightningActive_ = false;
-      effectStartTime_ = lastUpdate_; // Reset cycle
-      for (uint16_t i = 0; i < count_; i++) {
-        strip_.SetPixelColor(i, RgbColor(0, 0, 0));
-      }
+void LedStrip::writeOutput(const LedColor* frame) {
+  outputDirty_ = false;
+  bool white = output_->hasWhite();
+  OutputMode mode = output_->depth() > 8 ? OutputMode::Wide
+                    : ditherEnabled_     ? OutputMode::Dither
+                                         : OutputMode::Round;
+  uint8_t threshold = reverse8(ditherFrame_++);
+  uint16_t fractions;
+  if (white) {
+    switch (mode) {
+      case OutputMode::Wide: fractions = writeLevels<true, OutputMode::Wide>(frame, threshold); break;
+      case OutputMode::Dither: fractions = writeLevels<true, OutputMode::Dither>(frame, threshold); break;
+      default: fractions = writeLevels<true, OutputMode::Round>(frame, threshold); break;
     }
   } else {
-    // Dark between lightning
-    for (uint16_t i = 0; i < count_; i++) {
-      strip_.SetPixelColor(i, RgbColor(0, 0, 0));
+    switch (mode) {
+      case OutputMode::Wide: fractions = writeLevels<false, OutputMode::Wide>(frame, threshold); break;
+      case OutputMode::Dither: fractions = writeLevels<false, OutputMode::Dither>(frame, threshold); break;
+      default: fractions = writeLevels<false, OutputMode::Round>(frame, threshold); break;
     }
   }
+  ditherPending_ = mode == OutputMode::Dither && (fractions & 0xFF) != 0;
 }
 
-void LedStrip::renderRainbow() {
-  uint32_t elapsed = lastUpdate_ - effectStartTime_;
-  float hueOffset = (float)(elapsed % currentEffect_.speed) / currentEffect_.speed;
-  
+template <bool kWhite, LedStrip::OutputMode kMode>
+uint16_t LedStrip::writeLevels(const LedColor* frame, uint8_t threshold) {
+  uint16_t fractions = 0;
+  // Runs of equal pixels (fills, static segments) reuse the previous levels
+  LedColor last;
+  uint16_t r = 0;
+  uint16_t g = 0;
+  uint16_t b = 0;
+  uint16_t w = 0;
   for (uint16_t i = 0; i < count_; i++) {
-    float position = (float)i / count_;
-    float hue = fmod(position + hueOffset, 1.0f) * 360.0f;
-    
-    // Convert HSV to RGB (simple approximation)
-    float c = 1.0f;
-    float x = 1.0f - abs(fmod(hue / 60.0f, 2.0f) - 1.0f);
-    float r, g, b;
-    
-    if (hue < 60) { r = c; g = x; b = 0; }
-    else if (hue < 120) { r = x; g = c; b = 0; }
-    else if (hue < 180) { r = 0; g = c; b = x; }
-    else if (hue < 240) { r = 0; g = x; b = c; }
-    else if (hue < 300) { r = x; g = 0; b = c; }
-    else { r = c; g = 0; b = x; }
-    
-    RgbColor rainbowColor(
-      applyBrightness(r * 255),
-      applyBrightness(g * 255),
-      applyBrightness(b * 255)
-    );
-    strip_.SetPixelColor(i, rainbowColor);
-  }
-}
-
-void LedStrip::renderSparkle() {
-  if (lastUpdate_ - lastSparkleUpdate_ >= currentEffect_.speed) {
-    lastSparkleUpdate_ = lastUpdate_;
-    
-    RgbColor sparkleColor = colorFromHex(currentEffect_.primaryColor);
-    
-    // Fade existing sparkles
-    for (uint16_t i = 0; i < count_; i++) {
-      if (sparklePixels_[i] > 0) {
-        sparklePixels_[i] = max(0, sparklePixels_[i] - 20);
-        float intensity = sparklePixels_[i] / 255.0f;
-        RgbColor fadeColor(
-          applyBrightness(sparkleColor.R * intensity),
-          applyBrightness(sparkleColor.G * intensity),
-          applyBrightness(sparkleColor.B * intensity)
-        );
-        strip_.SetPixelColor(i, fadeColor);
-      } else {
-        strip_.SetPixelColor(i, RgbColor(0, 0, 0));
+    const LedColor& c = frame[i];
+    if (i == 0 || c.R != last.R || c.G != last.G || c.B != last.B) {
+      last = c;
+      r = outputLevel(c.R);
+      g = outputLevel(c.G);
+      b = outputLevel(c.B);
+      if (kWhite) {
+        // The common part of R, G and B goes to the white LED
+        w = min(r, min(g, b));
+        r -= w;
+        g -= w;
+        b -= w;
       }
     }
     
-    // Add new sparkles
-    uint8_t newSparkles = random(0, currentEffect_.intensity / 10 + 1);
-    for (uint8_t s = 0; s < newSparkles; s++) {
-      uint16_t pixel = random(0, count_);
-      sparklePixels_[pixel] = 255;
+    LedLevels levels;
+    if (kMode == OutputMode::Wide) {
+      // Q8.8 (max 0xFF00) to the full 16-bit range
+      levels = {widen(r), widen(g), widen(b), widen(w)};
+    } else if (kMode == OutputMode::Dither) {
+      // Round up when the fraction beats a threshold that walks a
+      // bit-reversed sequence over frames and an odd stride over pixels,
+      // so neighbours do not flip in step
+      fractions |= r | g | b | w;
+      levels = {ditherLevel(r, threshold), ditherLevel(g, threshold), ditherLevel(b, threshold),
+                ditherLevel(w, threshold)};
+      threshold += 89;
+    } else {
+      levels = {roundLevel(r), roundLevel(g), roundLevel(b), roundLevel(w)};
     }
+    output_->setPixel(i, levels);
   }
+  return fractions;
 }
 
 // Utility methods
-RgbColor LedStrip::colorFromHex(uint32_t color) const {
-  uint8_t r = applyBrightness((color >> 16) & 0xFF);
-  uint8_t g = applyBrightness((color >> 8) & 0xFF);
-  uint8_t b = applyBrightness(color & 0xFF);
-  return RgbColor(r, g, b);
-}
-
-RgbColor LedStrip::blendColors(const RgbColor& color1, const RgbColor& color2, float ratio) const {
-  ratio = constrain(ratio, 0.0f, 1.0f);
-  return RgbColor(
-    color1.R + (color2.R - color1.R) * ratio,
-    color1.G + (color2.G - color1.G) * ratio,
-    color1.B + (color2.B - color1.B) * ratio
-  );
-}
-
-uint8_t LedStrip::applyBrightness(uint8_t value) const {
-  return (value * brightness_) / 255;
-}
-
-float LedStrip::sineWave(uint32_t timeMs, uint32_t period) const {
-  float phase = (float)(timeMs % period) / period;
-  return sin(phase * TWO_PI) * 0.5f + 0.5f;
+void LedStrip::clearFrames() {
+  for (uint16_t i = 0; i < count_; i++) {
+    frames_[0][i] = LedColor();
+    frames_[1][i] = LedColor();
+  }
 }
 
-}  // namespace espmods::led
\ No newline at end of file
+}  // namespace espmods::led
@@ -3,29 +3,24 @@
 #include <Arduino.h>
 #include <NeoPixelBusLg.h>
 
-namespace espmods::led {
+#include <atomic>
 
-enum class LedEffect {
-  Off,
-  SolidColor,
-  Pulse,
-  GradientPulse,
-  RandomFlicker,
-  Strobe,
-  ColorWave,
-  Fire,
-  Lightning,
-  Rainbow,
-  Sparkle
-};
+#include "LedEffect.h"
+#include "LedOutput.h"
+#include "LedPixelPool.h"
+#include "LedRandom.h"
+#include "LedTimeline.h"
+
+namespace espmods::led {
 
-struct LedEffectConfig {
-  LedEffect effect = LedEffect::Off;
-  uint32_t primaryColor = 0xFF0000;    // Red default
-  uint32_t secondaryColor = 0x000000;  // Black default
-  uint32_t speed = 1000;               // Effect speed in milliseconds
-  uint8_t intensity = 255;             // Effect intensity (0-255)
-  bool reverse = false;                // Reverse direction if applicable
+/**
+ * @brief How a segment changes from its old effect to a new one
+ */
+enum class LedTransition {
+  Cut,        // Switch instantly
+  Crossfade,  // Blend the whole segment from old to new
+  Wipe,       // Sweep the new effect in along the segment direction
+  Dissolve    // Switch pixels over in a scattered order
 };
 
 /**
@@ -34,9 +29,46 @@ struct LedEffectConfig {
  * This class provides a simple wrapper around NeoPixelBus with common
  * LED effects suitable for Halloween displays, ambient lighting, and
  * other visual effects. The strip length is configurable at runtime.
+ * 
+ * Effects render into a back buffer that is published with an atomic
+ * index swap. Frames are produced either inline by update() or by an
+ * optional FreeRTOS task (startRenderTask()) pinned to the other core, so
+ * animation timing is independent of WiFi and web server work in loop().
+ * setEffect()/setBrightness() may be called from a single controlling
+ * task while the render task runs; changes apply at the next frame.
+ * 
+ * The strip can be split into up to kMaxSegments non-overlapping
+ * segments, each running an independent effect; all segments render in
+ * one pass into the shared pixel buffer and go out with a single Show().
+ * 
+ * Effect changes can be animated with setTransition(); the old and new
+ * effects then render side by side into scratch buffers that are
+ * allocated once, so switching effects does not allocate.
+ * 
+ * Effects are looked up in LedEffectRegistry, so applications can add
+ * their own next to the built-ins. Each segment's effect state lives in
+ * a block sized for that effect and reused across effect changes.
+ * 
+ * Effects render full-scale colours into a working buffer with 16 bits
+ * per channel (LedColor, Q8.8). Brightness and gamma are applied once per
+ * frame by the output stage through a 16-bit lookup table, followed by
+ * white extraction for RGBW outputs and either 16-bit output or 8-bit
+ * rounding with optional temporal dithering (setDithering()).
+ * 
+ * Audio-reactive effects read microphone analysis frames that arrive
+ * through a lock-free channel (setAudioSource()).
+ * 
+ * Pre-authored shows play from a binary LedTimeline (playTimeline()),
+ * streamed from flash or a file a few bytes at a time.
+ * 
+ * Live pixel data from another task (e.g. LedStreamReceiver for DDP and
+ * E1.31) takes over the strip through beginStream(): frames are triple
+ * buffered and swapped in as the next front frame without a copy.
  */
 class LedStrip {
  public:
+  static constexpr uint8_t kMaxSegments = 8;
+  
   /**
    * @brief Constructor for LED strip
    * @param pin GPIO pin connected to the LED strip data line
@@ -45,10 +77,53 @@ class LedStrip {
    */
   LedStrip(uint8_t pin, uint16_t count, uint8_t brightness = 128);
   
+  /**
+   * @brief Constructor for a strip with caller-provided output and buffers
+   * 
+   * Nothing is allocated for caller-provided frames; the output and
+   * buffers must outlive the strip. FixedLedStrip uses this with static
+   * storage.
+   * @param output Destination of the final pixel levels
+   * @param count Number of LEDs in the strip
+   * @param brightness Default brightness (0-255)
+   * @param frames Storage for 2 * count pixels (front and back buffer),
+   *               nullptr to allocate them
+   * @param scratch Storage for 2 * count pixels used by transitions,
+   *                nullptr to allocate it on the first setTransition()
+   */
+  LedStrip(LedOutput& output, uint16_t count, uint8_t brightness, LedColor* frames,
+           LedColor* scratch = nullptr);
+  
+  /**
+   * @brief Constructor for a strip whose buffers come from a shared pool
+   * 
+   * Takes the front and back buffer and, if the pool still has room, the
+   * transition buffers. A pool without room for the frames is a sizing
+   * mistake: the strip then allocates its frames on the heap instead, like
+   * the pin constructor. The output and pool must outlive the strip.
+   * @param output Destination of the final pixel levels
+   * @param count Number of LEDs in the strip
+   * @param brightness Default brightness (0-255)
+   * @param pool Pool with at least poolPixels(count) free pixels
+   */
+  LedStrip(LedOutput& output, uint16_t count, uint8_t brightness, LedPixelPool& pool);
+  
+  /**
+   * @brief Pool pixels a strip takes from a LedPixelPool
+   * @param count Number of LEDs in the strip
+   * @param transitions Include the transition buffers
+   */
+  static constexpr size_t poolPixels(uint16_t count, bool transitions = true) {
+    return (transitions ? 4 : 2) * static_cast<size_t>(count);
+  }
+  
+  LedStrip(const LedStrip&) = delete;
+  LedStrip& operator=(const LedStrip&) = delete;
+  
   /**
    * @brief Destructor - cleans up allocated memory
    */
-  ~LedStrip();
+  virtual ~LedStrip();
   
   /**
    * @brief Initialize the LED strip
@@ -58,15 +133,146 @@ class LedStrip {
   
   /**
    * @brief Update the LED effects - call this in loop()
+   * 
+   * Frames are rendered at most at the target frame rate, and Show() is
+   * only called when the rendered frame differs from the one on the strip.
    */
   void update();
   
+  /**
+   * @brief Render frames on a dedicated FreeRTOS task
+   * 
+   * After this call update() becomes a no-op and the task paces itself
+   * to the target frame rate. Not available for strips added to a
+   * LedController.
+   * @param core CPU core to pin the task to, -1 for the core not running the caller
+   * @param priority FreeRTOS task priority
+   * @return true if the task is running
+   */
+  bool startRenderTask(int8_t core = -1, uint8_t priority = 2);
+  
+  /**
+   * @brief Check whether frames are rendered by the render task
+   */
+  bool isRenderTaskRunning() const { return renderTask_ != nullptr; }
+  
   /**
    * @brief Set the current effect and configuration
+   * 
+   * Applies to the whole strip and replaces any segment layout.
    * @param config Effect configuration struct
    */
   void setEffect(const LedEffectConfig& config);
   
+  /**
+   * @brief Append a segment to the layout
+   * 
+   * The first call after setEffect() replaces the whole-strip segment.
+   * Pixels not covered by any segment stay off.
+   * @param segment Pixel range, effect and direction
+   * @return Segment index, or -1 if the table is full, the range is
+   *         invalid or it overlaps a segment already added
+   */
+  int8_t addSegment(const LedSegment& segment);
+  
+  /**
+   * @brief Change the effect of an existing segment
+   * @param index Segment index returned by addSegment()
+   * @param config Effect configuration struct
+   * @return false if the index is out of range
+   */
+  bool setSegmentEffect(uint8_t index, const LedEffectConfig& config);
+  
+  /**
+   * @brief Animate subsequent effect changes
+   * 
+   * The first non-Cut call allocates the transition scratch buffers
+   * (12 bytes per pixel); later changes reuse them.
+   * @param type Transition style, Cut disables transitions
+   * @param durationMs Transition length in milliseconds
+   * @return false if the transition buffers could not be allocated
+   */
+  bool setTransition(LedTransition type, uint16_t durationMs = 500);
+  
+  /**
+   * @brief Play a keyframe timeline on the render side
+   * 
+   * The timeline takes over effects and layout until it ends or
+   * stopTimeline() is called; the layout set with setEffect() and
+   * addSegment() then returns. Brightness records change the strip's
+   * brightness. Transition buffers are allocated here if needed, so
+   * keyframe fades never allocate during playback. The timeline must not
+   * be touched while it plays.
+   * @param timeline Timeline to play from its beginning
+   * @return false if the transition buffers could not be allocated
+   */
+  bool playTimeline(LedTimeline& timeline);
+  
+  /**
+   * @brief Stop the playing timeline and return to the configured layout
+   */
+  void stopTimeline();
+  
+  /**
+   * @brief Check whether a timeline is playing or about to start
+   */
+  bool isTimelinePlaying() const;
+  
+  /**
+   * @brief Hand the strip to an external frame source
+   * 
+   * The producer (one task, e.g. LedStreamReceiver) writes a frame into
+   * streamBuffer() and publishes it with commitStream(); the renderer
+   * swaps it in as the front frame and shows it right away, bypassing the
+   * frame rate like audio input. Frames are triple buffered, so neither
+   * side waits or copies; a frame the renderer has not taken yet is
+   * replaced by the next one. Effects, segments and timelines pause while
+   * frames arrive and resume from a blank frame after timeoutMs without
+   * one. Allocates two extra frame buffers (12 bytes per pixel) on the
+   * first call.
+   * @param timeoutMs Time without a frame before effects return
+   * @return false if the stream buffers could not be allocated
+   */
+  bool beginStream(uint16_t timeoutMs = 2500);
+  
+  /**
+   * @brief End the stream and return to effects
+   * 
+   * The producer must have stopped writing; call from the producer's task
+   * or after it stopped.
+   */
+  void endStream();
+  
+  /**
+   * @brief Check whether the renderer accepted beginStream()
+   */
+  bool isStreaming() const { return streamActive_.load(std::memory_order_acquire); }
+  
+  /**
+   * @brief Buffer for the next stream frame (producer side)
+   * 
+   * count pixels of effect colour. The buffer holds an older frame rather
+   * than the last committed one, so every pixel must be written before
+   * commitStream(). Changes after each commitStream().
+   * @return Frame buffer, nullptr until the renderer accepted beginStream()
+   */
+  LedColor* streamBuffer() { return isStreaming() ? streamInput_ : nullptr; }
+  
+  /**
+   * @brief Publish the frame written to streamBuffer() (producer side)
+   */
+  void commitStream();
+  
+  /**
+   * @brief Stream frames replaced before the renderer showed them
+   */
+  uint32_t getStreamFramesDropped() const { return streamFramesDropped_.load(std::memory_order_relaxed); }
+  
+  /**
+   * @brief Number of segments in the current layout
+   */
+  uint8_t getSegmentCount() const { return controlTable_.count; }
+  
   /**
    * @brief Quick method to set a solid color
    * @param color 24-bit RGB color (0xRRGGBB)
@@ -84,17 +290,105 @@ class LedStrip {
    */
   void setBrightness(uint8_t brightness);
   
+  /**
+   * @brief Enable or disable gamma correction in the output stage
+   * 
+   * Enabled by default. When disabled, brightness scales the effect
+   * colours linearly.
+   * @param enabled true to apply the gamma curve
+   */
+  void setGammaCorrection(bool enabled);
+  
+  /**
+   * @brief Enable or disable temporal dithering in the output stage
+   * 
+   * Dithering alternates between the two nearest 8-bit levels from frame
+   * to frame so dim gradients and slow fades do not visibly step. While
+   * any pixel sits between two levels the strip is refreshed every frame,
+   * even for static effects. Disabled by default.
+   * @param enabled true to dither the output
+   */
+  void setDithering(bool enabled);
+  
   /**
    * @brief Get current brightness
    * @return Current brightness (0-255)
    */
-  uint8_t getBrightness() const { return brightness_; }
+  uint8_t getBrightness() const { return requestedBrightness_.load(std::memory_order_relaxed); }
+  
+  /**
+   * @brief Restart the effects' random sequence from a fixed seed
+   * 
+   * Makes flicker, fire, sparkle and lightning reproducible for tests.
+   * Call before startRenderTask(); the generator is not shared across tasks.
+   * @param seed Seed value (0 selects the default seed)
+   */
+  void seedRandom(uint32_t seed);
+  
+  /**
+   * @brief Limit how often update() renders a frame
+   * @param fps Frames per second, 0 renders on every update() call
+   */
+  void setTargetFps(uint8_t fps);
+  
+  /**
+   * @brief Feed microphone analysis frames to audio-reactive effects
+   * 
+   * The strip becomes the channel's only consumer; connect the producer
+   * with MicI2S::setResultChannel(). A new mic frame triggers a render
+   * right away rather than at the next frame slot, from update() as well
+   * as on the render task, so it reaches the LEDs within one frame
+   * interval. Call before startRenderTask().
+   * @param channel Channel to read, nullptr to detach
+   */
+  void setAudioSource(audio::MicResultChannel* channel);
   
   /**
    * @brief Get strip length
    * @return Number of LEDs in strip
    */
   uint16_t getLength() const { return count_; }
+  
+  /**
+   * @brief Read a pixel from the most recently published frame
+   * @param index Pixel index
+   * @return Effect colour of the pixel before brightness and gamma, black if out of range
+   */
+  RgbColor getPixelColor(uint16_t index) const;
+
+  /**
+   * @brief Time spent rendering the last frame, excluding Show()
+   * 
+   * Use this to compare the fixed-point and float render paths
+   * (ESPMODS_LED_FIXED_POINT) on the target strip length.
+   * @return Render time of the last update() in microseconds
+   */
+  uint32_t getRenderMicros() const { return renderMicros_; }
+  
+  /**
+   * @brief Number of frames pushed to the strip with Show()
+   */
+  uint32_t getFramesShown() const { return framesShown_; }
+  
+  /**
+   * @brief Number of rendered frames skipped because nothing changed
+   */
+  uint32_t getFramesSkipped() const { return framesSkipped_; }
+  
+  /**
+   * @brief Sample-to-Show() latency of the last frame that carried new audio
+   * 
+   * Measured from MicDetectionResult::captureMicros (end of the analysis
+   * window) until Show() returned. The strip's wire time, about 30 us per
+   * pixel, adds to this for the last pixel.
+   * @return Latency in microseconds, 0 before the first audio-driven frame
+   */
+  uint32_t getAudioLatencyMicros() const { return audioLatencyMicros_; }
+  
+  /**
+   * @brief Highest getAudioLatencyMicros() since setAudioSource()
+   */
+  uint32_t getMaxAudioLatencyMicros() const { return maxAudioLatencyMicros_; }
 
   // Quick effect methods for common use cases
   void pulseColor(uint32_t color, uint32_t speed = 2000);
@@ -106,44 +400,200 @@ class LedStrip {
   void fire(uint8_t intensity = 128);
   void rainbow(uint32_t speed = 5000);
   void sparkle(uint32_t color, uint8_t density = 10);
+  
+  // Audio-reactive effects, see setAudioSource()
+  void vuMeter(uint32_t lowColor, uint32_t highColor, uint8_t sensitivity = 160);
+  void beatPulse(uint32_t color, uint32_t speed = 300);
 
  private:
-  // Effect rendering methods
-  void renderOff();
-  void renderSolidColor();
-  void renderPulse();
-  void renderGradientPulse();
-  void renderRandomFlicker();
-  void renderStrobe();
-  void renderColorWave();
-  void renderFire();
-  void renderLightning();
-  void renderRainbow();
-  void renderSparkle();
+  static constexpr uint8_t kDefaultTargetFps = 60;
+  static constexpr uint32_t kRenderTaskStackSize = 4096;
+  
+  // Segment layout as exchanged between the control side and the renderer
+  struct SegmentTable {
+    LedSegment segments[kMaxSegments];
+    uint32_t revisions[kMaxSegments];  // Bumped whenever a segment's effect is (re)set
+    uint8_t count = 0;
+    bool wholeStrip = true;            // Layout came from setEffect()
+    LedTransition transition = LedTransition::Cut;
+    uint16_t transitionMs = 0;
+  };
+  
+  // Render-side state of one segment
+  struct SegmentState {
+    LedSegment segment;
+    uint32_t revision = 0;
+    LedEffectClock clock;
+    bool dirty = true;                 // Forces a repaint after config changes
+    uint8_t bank = 0;                  // Effect state bank
+    const LedEffectType* type = nullptr;
+    void* state = nullptr;             // Effect state block in this bank
+  };
+  
+  // Outgoing effect of a segment while a transition runs
+  struct TransitionState {
+    SegmentState outgoing;
+    uint32_t startTime = 0;
+    uint8_t seed = 0;                  // Dissolve pixel order
+    bool active = false;
+  };
+  
+  // Frame production (runs inline in update(), on the render task or from
+  // a LedController): composeFrame() renders and fills the output, and
+  // returns false if the strip does not need a Show()
+  friend class LedController;
+  static void renderTaskEntry(void* arg);
+  void renderFrame(uint32_t now);
+  bool composeFrame(uint32_t now);
+  void pushFrame();
+  void pollAudio();
+  bool allocateScratch();
+  bool inputPending() const;
+  
+  // Stream input (render side)
+  void startStream();
+  void stopStream();
+  bool updateStream(uint32_t now);
+  void resumeEffects();
+  
+  // Timeline playback (render side)
+  void startTimeline(LedTimeline* timeline, uint32_t now);
+  void endTimeline();
+  void advanceTimeline(uint32_t now);
+  bool decodeTimelineFrames(uint32_t now, const LedColor* front);
+  void applyTimelineEvent(const LedTimeline::Event& event, uint32_t now);
+  bool renderSegment(SegmentState& seg);
+  void renderTransition(uint8_t slot);
+  void blendTransition(const SegmentState& seg, const TransitionState& transition, uint16_t progress);
+  void applyPendingControls(uint32_t now);
+  void applySegmentTable(const SegmentTable& table, uint32_t now);
+  void resetSegment(SegmentState& seg, uint8_t slot, uint32_t now);
+  void* effectState(uint8_t slot, uint8_t bank, size_t size);
+  void publishSegmentTable();
+  
+  // Output stage: brightness, gamma and dithering applied once per frame
+  void buildOutputTable();
+  enum class OutputMode : uint8_t { Round, Dither, Wide };
+  void writeOutput(const LedColor* frame);
+  template <bool kWhite, OutputMode kMode>
+  uint16_t writeLevels(const LedColor* frame, uint8_t threshold);
+  uint16_t outputLevel(uint16_t value) const {
+    // 8-bit effect colours land on table entries; fractions interpolate
+    uint8_t index = value >> 8;
+    uint8_t frac = value & 0xFF;
+    uint16_t low = outputTable_[index];
+    if (frac == 0) {
+      return low;
+    }
+    return low + (((outputTable_[index + 1] - low) * frac) >> 8);
+  }
   
   // Utility methods
-  RgbColor colorFromHex(uint32_t color) const;
-  RgbColor blendColors(const RgbColor& color1, const RgbColor& color2, float ratio) const;
-  uint8_t applyBrightness(uint8_t value) const;
-  float sineWave(uint32_t timeMs, uint32_t period) const;
+  void clearFrames();
   
   // Hardware
-  NeoPixelBusLg<NeoGrbFeature, NeoEsp32I2s0800KbpsMethod> strip_;
+  LedOutput* output_;
+  bool ownsOutput_;                            // output_ is ours to free
+  bool ownsFrames_;                            // frameStorage_ is ours to free
+  bool ownsScratch_;                           // scratch_ was allocated by the strip
+  LedColor* frameStorage_;                     // Block behind frames_; stream input rotates frames_
   uint16_t count_;
-  uint8_t brightness_;
+  uint8_t brightness_;                         // Applied by the render side
+  std::atomic<uint8_t> requestedBrightness_;   // Written by setBrightness()
+  
+  // Output stage: effect value -> Q8.8 strip level incl. brightness and gamma;
+  // the extra entry lets outputLevel() interpolate above 255.0
+  uint16_t outputTable_[257];
+  bool gammaEnabled_;
+  bool ditherEnabled_;
+  std::atomic<bool> requestedGamma_;           // Written by setGammaCorrection()
+  std::atomic<bool> requestedDither_;          // Written by setDithering()
+  bool outputDirty_;                           // Table changed, re-send the front frame
+  bool ditherPending_;                         // Last frame had fractional levels
+  uint8_t ditherFrame_;
   
-  // Effect state
-  LedEffectConfig currentEffect_;
-  uint32_t effectStartTime_;
+  // Segment layout: controlTable_ is owned by the caller's task and
+  // published to pendingTable_ through a seqlock (odd while being written)
+  SegmentTable controlTable_;
+  SegmentTable pendingTable_;
+  std::atomic<uint32_t> pendingTableSeq_;
+  uint32_t appliedTableSeq_;
+  uint32_t nextRevision_;
+  
+  // Render-side segment state
+  SegmentState segments_[kMaxSegments];
+  uint8_t segmentCount_;
   uint32_t lastUpdate_;
+  LedRandom random_;        // Render-side PRNG for all effects
+  
+  // Effect state per segment slot; transitions flip a segment to the other
+  // bank so old and new effects keep separate state. Blocks are allocated
+  // on first use and only grow, so effects that never run cost nothing.
+  uint8_t* stateBlocks_[kMaxSegments][2];
+  size_t stateCapacity_[kMaxSegments][2];
+  
+  // Transitions: old/new effects render into scratch_, blended into back_
+  TransitionState transitions_[kMaxSegments];
+  LedColor* scratch_[2];
+  LedTransition transitionType_;
+  uint16_t transitionMs_;
+  
+  // Double buffering: effects write target_ (back_ or scratch),
+  // frontIndex_ names the published frame
+  LedColor* frames_[2];
+  LedColor* back_;
+  LedColor* target_;
+  std::atomic<uint8_t> frontIndex_;
+  
+  // Optional render task, or a LedController driving this strip
+  TaskHandle_t renderTask_;
+  bool controlled_;
+  std::atomic<TaskHandle_t> wakeTask_;         // Task that renders this strip, notified on stream frames
+  
+  // Frame scheduling
+  std::atomic<uint32_t> frameIntervalMs_;
+  uint32_t lastFrameTime_;
+  
+  // Timeline playback: requested by the control side, played by the
+  // renderer with its own layout that replaces the control table
+  std::atomic<LedTimeline*> requestedTimeline_;
+  std::atomic<uint32_t> timelineRequestSeq_;
+  uint32_t appliedTimelineSeq_;
+  LedTimeline* timeline_;                      // Render side, nullptr when idle
+  SegmentTable timelineTable_;
+  uint32_t timelineRevision_;
+  bool timelineFrameMode_;                     // Layout is cleared for pixel frames
+  
+  // Audio input, polled once per frame; the newest mic frame wins
+  audio::MicResultChannel* audioChannel_;
+  LedAudioFrame audio_;
+  bool audioShowPending_;                      // Next Show() carries a new mic frame
+  
+  // Stream input: the producer trades its filled buffer through
+  // streamMailbox_ (bit 0 set while unread) for the one the renderer gave
+  // up last, so frames_, the mailbox and streamInput_ rotate through four
+  // buffers without copies
+  LedColor* streamStorage_;                    // 2 * count_, allocated by beginStream()
+  std::atomic<bool> streamRequested_;
+  std::atomic<uint32_t> streamRequestSeq_;
+  std::atomic<uint16_t> streamTimeoutMs_;
+  std::atomic<bool> streamActive_;             // Buffers are lent to the producer
+  std::atomic<uintptr_t> streamMailbox_;
+  std::atomic<uint32_t> streamFramesDropped_;
+  LedColor* streamInput_;                      // Producer side while streaming
+  LedColor* streamSpare_[2];                   // Render side: stream buffers while idle
+  uint32_t appliedStreamSeq_;
+  uint32_t streamFrameTime_;
+  bool streamLent_;
+  bool streamShowing_;                         // The front frame came from the stream
+  bool streamFrameNew_;                        // Not sent to the output yet
   
-  // Effect-specific state variables
-  float wavePosition_;
-  uint32_t lastFlickerUpdate_;
-  uint32_t lightningStartTime_;
-  bool lightningActive_;
-  uint32_t lastSparkleUpdate_;
-  uint8_t* sparklePixels_;  // Array to track sparkle states
+  // Profiling
+  uint32_t renderMicros_;
+  uint32_t framesShown_;
+  uint32_t framesSkipped_;
+  uint32_t audioLatencyMicros_;
+  uint32_t maxAudioLatencyMicros_;
 };
 
 }  // namespace espmods::led
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "LedTimeline.h"
+
+namespace espmods::led {
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'L', 'E', 'D', 'T'};
+constexpr size_t kHeaderSize = 8;
+constexpr uint8_t kFlagReverse = 0x01;
+
+// Frame runs: type in the top two bits, length - 1 below
+constexpr uint8_t kRunSkip = 0;
+constexpr uint8_t kRunRepeat = 1;
+constexpr uint8_t kRunLiteral = 2;
+constexpr uint8_t kRunLengthMask = 0x3F;
+
+static_assert(LedTimeline::kReadBufferSize <= 255, "Read buffer indices are 8-bit");
+
+inline LedColor unpackColor(const uint8_t* rgb) {
+  return LedColor(RgbColor(rgb[0], rgb[1], rgb[2]));
+}
+
+}  // namespace
+
+LedTimeline::LedTimeline(LedTimelineSource& source)
+    : source_(source),
+      buffer_{},
+      bufferFill_(0),
+      bufferPosition_(0),
+      pixelCount_(0),
+      startTime_(0),
+      recordTime_(0),
+      nextOp_(Op::End),
+      haveRecord_(false),
+      loop_(false),
+      finished_(true) {}
+
+bool LedTimeline::start(uint32_t now) {
+  finished_.store(false, std::memory_order_release);
+  startTime_ = now;
+  if (!readHeader()) {
+    finish();
+    return false;
+  }
+  return true;
+}
+
+bool LedTimeline::readHeader() {
+  bufferFill_ = 0;
+  bufferPosition_ = 0;
+  haveRecord_ = false;
+  recordTime_ = 0;
+  if (!source_.rewind()) {
+    return false;
+  }
+  uint8_t header[kHeaderSize];
+  if (!readBytes(header, kHeaderSize) || memcmp(header, kMagic, sizeof(kMagic)) != 0 ||
+      header[4] != kVersion) {
+    return false;
+  }
+  pixelCount_ = header[6] | header[7] << 8;
+  return true;
+}
+
+bool LedTimeline::poll(uint32_t now, Op& op) {
+  while (!isFinished()) {
+    if (!haveRecord_) {
+      // The end of the stream counts as an End record at the last record's time
+      uint32_t delay = 0;
+      uint8_t code = static_cast<uint8_t>(Op::End);
+      if (readVarint(delay) && (!readByte(code) || code > static_cast<uint8_t>(Op::Frame))) {
+        finish();
+        return false;
+      }
+      recordTime_ += delay;
+      nextOp_ = static_cast<Op>(code);
+      haveRecord_ = true;
+    }
+    if (now - startTime_ < recordTime_) {
+      return false;
+    }
+    if (nextOp_ != Op::End) {
+      op = nextOp_;
+      return true;
+    }
+    // A zero-length pass would loop forever within one frame
+    if (!loop_ || recordTime_ == 0) {
+      finish();
+      return false;
+    }
+    startTime_ += recordTime_;
+    if (!readHeader()) {
+      finish();
+      return false;
+    }
+  }
+  return false;
+}
+
+bool LedTimeline::readEvent(Event& event) {
+  haveRecord_ = false;
+  event.op = nextOp_;
+  uint8_t flags = 0;
+  switch (nextOp_) {
+    case Op::Effect: {
+      uint8_t effect = 0;
+      if (!readByte(event.segment) || !readByte(effect) || !readColor(event.config.primaryColor) ||
+          !readColor(event.config.secondaryColor) || !readVarint(event.config.speed) ||
+          !readByte(event.config.intensity) || !readByte(flags)) {
+        return false;
+      }
+      event.config.effect = static_cast<LedEffect>(effect);
+      event.config.reverse = flags & kFlagReverse;
+      return true;
+    }
+    case Op::Layout:
+      if (!readByte(event.segmentCount)) {
+        return false;
+      }
+      for (uint8_t s = 0; s < event.segmentCount; s++) {
+        uint32_t start = 0;
+        uint32_t length = 0;
+        if (!readVarint(start) || !readVarint(length) || !readByte(flags)) {
+          return false;
+        }
+        // Segments beyond the table are read and dropped
+        if (s < kMaxLayoutSegments) {
+          event.segments[s] = LedSegment();
+          event.segments[s].start = min<uint32_t>(start, 0xFFFF);
+          event.segments[s].length = min<uint32_t>(length, 0xFFFF);
+          event.segments[s].effect.reverse = flags & kFlagReverse;
+        }
+      }
+      event.segmentCount = min(event.segmentCount, kMaxLayoutSegments);
+      return true;
+    case Op::Transition:
+      return readByte(event.value) && readVarint(event.durationMs);
+    case Op::Color:
+      event.config = LedEffectConfig();
+      event.config.effect = LedEffect::SolidColor;
+      return readColor(event.config.primaryColor) && readVarint(event.durationMs);
+    case Op::Brightness:
+      return readByte(event.value);
+    default:
+      return false;
+  }
+}
+
+bool LedTimeline::decodeFrame(LedColor* out, const LedColor* base, uint16_t count) {
+  haveRecord_ = false;
+  uint16_t pixel = 0;
+  while (pixel < pixelCount_) {
+    uint8_t code = 0;
+    if (!readByte(code)) {
+      return false;
+    }
+    uint16_t length = (code & kRunLengthMask) + 1;
+    if (length > pixelCount_ - pixel) {
+      return false;
+    }
+    // Pixels past the end of the strip are read and dropped
+    uint16_t end = min<uint16_t>(pixel + length, count);
+    uint8_t rgb[3];
+    switch (code >> 6) {
+      case kRunSkip:
+        if (base != out) {
+          for (uint16_t i = pixel; i < end; i++) {
+            out[i] = base[i];
+          }
+        }
+        break;
+      case kRunRepeat: {
+        if (!readBytes(rgb, sizeof(rgb))) {
+          return false;
+        }
+        LedColor color = unpackColor(rgb);
+        for (uint16_t i = pixel; i < end; i++) {
+          out[i] = color;
+        }
+        break;
+      }
+      case kRunLiteral:
+        for (uint16_t i = pixel; i < pixel + length; i++) {
+          // Most pixels come straight from the buffer without a copy
+          const uint8_t* data = rgb;
+          if (bufferFill_ - bufferPosition_ >= 3) {
+            data = buffer_ + bufferPosition_;
+            bufferPosition_ += 3;
+          } else if (!readBytes(rgb, sizeof(rgb))) {
+            return false;
+          }
+          if (i < end) {
+            out[i] = unpackColor(data);
+          }
+        }
+        break;
+      default:
+        return false;
+    }
+    pixel += length;
+  }
+  // Strip pixels the timeline does not cover keep the previous frame
+  if (base != out) {
+    for (uint16_t i = pixel; i < count; i++) {
+      out[i] = base[i];
+    }
+  }
+  return true;
+}
+
+bool LedTimeline::refill() {
+  bufferFill_ = source_.read(buffer_, kReadBufferSize);
+  bufferPosition_ = 0;
+  return bufferFill_ > 0;
+}
+
+bool LedTimeline::readByte(uint8_t& value) {
+  if (bufferPosition_ == bufferFill_ && !refill()) {
+    return false;
+  }
+  value = buffer_[bufferPosition_++];
+  return true;
+}
+
+bool LedTimeline::readBytes(uint8_t* data, size_t length) {
+  while (length > 0) {
+    if (bufferPosition_ == bufferFill_ && !refill()) {
+      return false;
+    }
+    size_t count = min<size_t>(length, bufferFill_ - bufferPosition_);
+    memcpy(data, buffer_ + bufferPosition_, count);
+    bufferPosition_ += count;
+    data += count;
+    length -= count;
+  }
+  return true;
+}
+
+bool LedTimeline::readVarint(uint32_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    uint8_t byte = 0;
+    if (!readByte(byte)) {
+      return false;
+    }
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LedTimeline::readColor(uint32_t& color) {
+  uint8_t rgb[3];
+  if (!readBytes(rgb, sizeof(rgb))) {
+    return false;
+  }
+  color = static_cast<uint32_t>(rgb[0]) << 16 | rgb[1] << 8 | rgb[2];
+  return true;
+}
+
+}  // namespace espmods::led
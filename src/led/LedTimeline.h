@@ -0,0 +1,186 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#include "LedEffect.h"
+#include "LedMath.h"
+
+namespace espmods::led {
+
+/**
+ * @brief Byte stream a timeline is played from
+ */
+class LedTimelineSource {
+ public:
+  virtual ~LedTimelineSource() = default;
+
+  /**
+   * @brief Read up to length bytes
+   * @return Bytes read, 0 at the end of the stream
+   */
+  virtual size_t read(uint8_t* buffer, size_t length) = 0;
+
+  /**
+   * @brief Seek back to the first byte
+   */
+  virtual bool rewind() = 0;
+};
+
+/**
+ * @brief Timeline stored in a constant array
+ *
+ * On the ESP32 constant data stays in memory-mapped flash, so a
+ * `const uint8_t show[] = {...}` plays without being copied to RAM.
+ */
+class LedTimelineMemorySource final : public LedTimelineSource {
+ public:
+  LedTimelineMemorySource(const uint8_t* data, size_t size) : data_(data), size_(size), position_(0) {}
+
+  size_t read(uint8_t* buffer, size_t length) override {
+    size_t count = min(length, size_ - position_);
+    memcpy(buffer, data_ + position_, count);
+    position_ += count;
+    return count;
+  }
+
+  bool rewind() override {
+    position_ = 0;
+    return true;
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t position_;
+};
+
+/**
+ * @brief Timeline read from an open file, e.g. a LittleFS fs::File
+ *
+ * Any type with read(uint8_t*, size_t) and seek(uint32_t) works. The file
+ * must stay open while the timeline plays.
+ */
+template <typename T_FILE>
+class LedTimelineFileSource final : public LedTimelineSource {
+ public:
+  explicit LedTimelineFileSource(T_FILE& file) : file_(file) {}
+
+  size_t read(uint8_t* buffer, size_t length) override { return file_.read(buffer, length); }
+  bool rewind() override { return file_.seek(0); }
+
+ private:
+  T_FILE& file_;
+};
+
+/**
+ * @brief Player for a compact binary show timeline
+ *
+ * A timeline is a header followed by timed records. LedStrip::playTimeline()
+ * plays it on the strip's render side, reading the source through a
+ * kReadBufferSize byte buffer; pixel frames are decoded straight into the
+ * strip's back buffer, so no frame is ever held by the player.
+ *
+ * All integers are little-endian; "varint" is unsigned LEB128.
+ *
+ *   Header:  'L' 'E' 'D' 'T', version (1), reserved (0), pixel count (u16)
+ *   Record:  delay since the previous record in ms (varint), opcode (u8), payload
+ *
+ *   0x00 End         -                    stop, or restart when looping
+ *   0x01 Effect      segment (u8, 0xFF = whole strip), effect (u8),
+ *                    primary (u24 RGB), secondary (u24 RGB), speed (varint),
+ *                    intensity (u8), flags (u8, bit 0 = reverse)
+ *   0x02 Layout      count (u8), per segment: start (varint),
+ *                    length (varint), flags (u8, bit 0 = reverse, kept
+ *                    until an Effect record sets the segment's flags);
+ *                    segments off the strip or overlapping an earlier one
+ *                    are skipped
+ *   0x03 Transition  type (u8, LedTransition), duration ms (varint)
+ *   0x04 Color       colour (u24 RGB), fade ms (varint); whole-strip
+ *                    crossfade to a solid colour keyframe
+ *   0x05 Brightness  brightness (u8)
+ *   0x06 Frame       pixel runs until pixel count pixels are covered; each
+ *                    run is a byte with the type in bits 7-6 and length - 1
+ *                    in bits 5-0:
+ *                      00 skip     keep the pixels of the previous frame
+ *                      01 repeat   one RGB colour (3 bytes) for all pixels
+ *                      10 literal  one RGB colour (3 bytes) per pixel
+ *
+ * Skips make frames deltas against whatever the strip showed before, so
+ * the first frame after effect records should not rely on them.
+ */
+class LedTimeline {
+ public:
+  static constexpr size_t kReadBufferSize = 64;
+  static constexpr uint8_t kVersion = 1;
+  static constexpr uint8_t kWholeStrip = 0xFF;
+  static constexpr uint8_t kMaxLayoutSegments = 8;
+
+  enum class Op : uint8_t { End, Effect, Layout, Transition, Color, Brightness, Frame };
+
+  /**
+   * @param source Stream to play; must outlive the timeline
+   */
+  explicit LedTimeline(LedTimelineSource& source);
+
+  LedTimeline(const LedTimeline&) = delete;
+  LedTimeline& operator=(const LedTimeline&) = delete;
+
+  /**
+   * @brief Restart from the beginning at the end instead of stopping
+   */
+  void setLoop(bool loop) { loop_ = loop; }
+
+  /**
+   * @brief Check whether playback reached the end (or hit a malformed record)
+   */
+  bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Pixel count from the header of the playing timeline
+   */
+  uint16_t getPixelCount() const { return pixelCount_; }
+
+ private:
+  friend class LedStrip;
+
+  // Payload of a non-frame record
+  struct Event {
+    Op op;
+    uint8_t segment;                          // Effect: target segment
+    LedEffectConfig config;                   // Effect / Color
+    uint8_t value;                            // Brightness, transition type
+    uint32_t durationMs;                      // Transition / Color fade
+    uint8_t segmentCount;                     // Layout
+    LedSegment segments[kMaxLayoutSegments];  // Layout, effects Off
+  };
+
+  // Playback, called by the strip's render side only
+  bool start(uint32_t now);
+  bool poll(uint32_t now, Op& op);
+  bool readEvent(Event& event);
+  bool decodeFrame(LedColor* out, const LedColor* base, uint16_t count);
+  void finish() { finished_.store(true, std::memory_order_release); }
+
+  bool readHeader();
+  bool readByte(uint8_t& value);
+  bool readBytes(uint8_t* data, size_t length);
+  bool readVarint(uint32_t& value);
+  bool readColor(uint32_t& color);
+  bool refill();
+
+  LedTimelineSource& source_;
+  uint8_t buffer_[kReadBufferSize];
+  uint8_t bufferFill_;
+  uint8_t bufferPosition_;
+  uint16_t pixelCount_;
+  uint32_t startTime_;                        // Time base of the current pass
+  uint32_t recordTime_;                       // Due time of the next record, ms from startTime_
+  Op nextOp_;
+  bool haveRecord_;                           // nextOp_/recordTime_ are read, payload is not
+  bool loop_;
+  std::atomic<bool> finished_;
+};
+
+}  // namespace espmods::led
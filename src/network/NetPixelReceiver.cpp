@@ -0,0 +1,62 @@
+#include "NetPixelReceiver.h"
+
+#include <espmods/core.hpp>
+
+using espmods::core::LogSerial;
+
+namespace espmods::network {
+
+NetPixelReceiver::NetPixelReceiver(led::LedStrip& strip)
+    : receiver_(strip), protocol_(Protocol::Ddp), listening_(false) {}
+
+NetPixelReceiver::~NetPixelReceiver() {
+  end();
+}
+
+bool NetPixelReceiver::begin(Protocol protocol, uint16_t timeoutMs) {
+  end();
+  protocol_ = protocol;
+  if (!receiver_.begin(timeoutMs)) {
+    LogSerial.println("Pixel receiver: no memory for stream buffers");
+    return false;
+  }
+  uint16_t port = protocol == Protocol::Ddp ? led::LedStreamReceiver::kDdpPort
+                                            : led::LedStreamReceiver::kE131Port;
+  if (!udp_.listen(port)) {
+    LogSerial.println("Pixel receiver: failed to open UDP port");
+    receiver_.end();
+    return false;
+  }
+  // Runs on the AsyncUDP task; packet.data() points into the lwIP buffer
+  udp_.onPacket([this](AsyncUDPPacket& packet) {
+    if (protocol_ == Protocol::Ddp) {
+      receiver_.handleDdp(packet.data(), packet.length(), millis());
+    } else {
+      receiver_.handleE131(packet.data(), packet.length(), millis());
+    }
+  });
+  listening_ = true;
+  LogSerial.print("Pixel receiver listening on UDP port ");
+  LogSerial.println(port);
+  return true;
+}
+
+bool NetPixelReceiver::setUniverse(uint16_t universe) {
+  if (listening_) {
+    return false;
+  }
+  receiver_.setUniverse(universe);
+  return true;
+}
+
+void NetPixelReceiver::end() {
+  if (!listening_) {
+    return;
+  }
+  // No packet callback runs once the socket is closed
+  udp_.close();
+  receiver_.end();
+  listening_ = false;
+}
+
+}  // namespace espmods::network
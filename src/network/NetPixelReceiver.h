@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+#include <AsyncUDP.h>
+
+#include "led/LedStreamReceiver.h"
+
+namespace espmods::network {
+
+/**
+ * @brief UDP listener that drives a LedStrip from a show controller
+ * 
+ * Receives DDP (port 4048) or unicast E1.31 (port 5568) with AsyncUDP
+ * and decodes each packet in place through led::LedStreamReceiver: pixel
+ * data goes from the lwIP packet buffer straight into the strip's stream
+ * buffer. Packets are handled on the AsyncUDP task as they arrive, and a
+ * completed frame wakes the strip's render task, so nothing needs to be
+ * polled from loop(). Start it once WiFi is connected (NetWifiOta).
+ */
+class NetPixelReceiver {
+ public:
+  enum class Protocol : uint8_t { Ddp, E131 };
+  
+  /**
+   * @param strip Strip to drive; must outlive the receiver
+   */
+  explicit NetPixelReceiver(led::LedStrip& strip);
+  
+  ~NetPixelReceiver();
+  
+  NetPixelReceiver(const NetPixelReceiver&) = delete;
+  NetPixelReceiver& operator=(const NetPixelReceiver&) = delete;
+  
+  /**
+   * @brief Take over the strip and start listening
+   * @param protocol Packet format to accept
+   * @param timeoutMs Time without a frame before the strip's effects return
+   * @return false if the port could not be opened or the strip's stream
+   *         buffers could not be allocated
+   */
+  bool begin(Protocol protocol = Protocol::Ddp, uint16_t timeoutMs = 2500);
+  
+  /**
+   * @brief Stop listening and return the strip to its effects
+   */
+  void end();
+  
+  /**
+   * @brief First E1.31 universe, see led::LedStreamReceiver::setUniverse()
+   *
+   * Packets are decoded on the AsyncUDP task, so the universe can only
+   * change while the receiver is not listening; call before begin() or
+   * after end().
+   * @return false if the receiver is listening and nothing changed
+   */
+  bool setUniverse(uint16_t universe);
+  
+  /**
+   * @brief Check whether the receiver is listening
+   */
+  bool isListening() const { return listening_; }
+  
+  /**
+   * @brief Packet, frame and sequence counters since begin()
+   */
+  const led::LedStreamReceiver::Stats& getStats() const { return receiver_.getStats(); }
+
+ private:
+  led::LedStreamReceiver receiver_;
+  AsyncUDP udp_;
+  Protocol protocol_;
+  bool listening_;
+};
+
+}  // namespace espmods::network